@@ -0,0 +1,258 @@
+// Host benchmark for FcobProgressTracker: ns/frame and ns/LED across map
+// sizes (including a 400-row wall panel), plans, snake, wobble and easing,
+// full-strip repaints (brightness transitions), the loop-side cost of
+// background rendering and validate_led_map at scale, plus timings of the
+// component scenarios in scenarios.h. Pass/fail checks live in fcob_check.
+//
+//   make -C stairs-ctrl/bench run
+//   ./fcob_bench --frames 300 --filter 244
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "rig.h"
+#include "scenarios.h"
+
+using esphome::Color;
+using ledhelpers::EaseProfile;
+using ledhelpers::FlowMode;
+using ledhelpers::RowOrder;
+
+namespace {
+
+using namespace bench;
+
+struct Result {
+  double ns_per_frame;
+  double ns_per_led;
+  double writes_per_frame;
+};
+
+// Run `frames` frames of one plan at a 16 ms virtual frame interval.
+Result run_plan(const led_map_t &map, int leds, FlowMode flow, bool snake, bool wobble, EaseProfile ease,
+                int frames) {
+  bench::MockStrip strip(leds);
+  ledhelpers::FcobProgressTracker tracker;
+  tracker.bind_map(&map);
+
+  ledhelpers::RuntimeConfig cfg;
+  cfg.per_led_ms = 6;
+  cfg.fade_steps = 3;
+  cfg.row_threshold = 0.5f;
+  cfg.snake = snake;
+  cfg.ease = ease;
+  cfg.wobble_enabled = wobble;
+  cfg.wobble_amp_deg = 6.0f;
+  cfg.wobble_freq_deg = 12.0f;
+  cfg.derive();
+  cfg.version = ledhelpers::next_config_version();
+  const Color base(255, 170, 90);
+
+  if (flow == FlowMode::Off) {
+    // Start from a fully lit strip so the OFF plan has work to do.
+    tracker.start_effect({FlowMode::Fill, RowOrder::BottomToTop}, false);
+    ledhelpers::RuntimeConfig fast = cfg;
+    fast.analytic_timing = true;
+    fast.per_led_ms = 1;
+    fast.version = ledhelpers::next_config_version();
+    uint32_t t = 0;
+    while (!tracker.finished()) tracker.render_frame(strip, fast, base, t += 1000);
+  }
+  tracker.start_effect({flow, RowOrder::BottomToTop}, flow == FlowMode::Off);
+
+  uint32_t now_ms = 0;
+  uint64_t writes = 0;
+  const auto t0 = Clock::now();
+  for (int f = 0; f < frames; ++f) {
+    tracker.render_frame(strip, cfg, base, now_ms);
+    writes += tracker.leds_written();
+    now_ms += 16;
+  }
+  const auto t1 = Clock::now();
+  const double ns = elapsed_ns(t0, t1);
+  return {ns / frames, ns / frames / leds, (double) writes / frames};
+}
+
+// Brightness transition on a fully lit strip: every frame is a full repaint.
+double run_transition(const led_map_t &map, int leds, bool wobble, int frames) {
+  bench::MockStrip strip(leds);
+  ledhelpers::FcobProgressTracker tracker;
+  tracker.bind_map(&map);
+  ledhelpers::RuntimeConfig cfg;
+  cfg.per_led_ms = 1;
+  cfg.analytic_timing = true;
+  cfg.wobble_enabled = wobble;
+  cfg.wobble_amp_deg = 6.0f;
+  cfg.wobble_freq_deg = 12.0f;
+  cfg.derive();
+  cfg.version = ledhelpers::next_config_version();
+  const Color base(255, 170, 90);
+  tracker.start_effect({FlowMode::Fill, RowOrder::BottomToTop}, false);
+  uint32_t now_ms = 0;
+  while (!tracker.finished()) tracker.render_frame(strip, cfg, base, now_ms += 1000);
+
+  const auto t0 = Clock::now();
+  for (int f = 0; f < frames; ++f) {
+    tracker.invalidate_output();
+    tracker.render_frame(strip, cfg, base, now_ms += 16);
+  }
+  const auto t1 = Clock::now();
+  return elapsed_ns(t0, t1) / frames;
+}
+
+double time_validate(const led_map_t &map, int led_count, int reps) {
+  const auto t0 = Clock::now();
+  size_t sink = 0;
+  for (int i = 0; i < reps; ++i) sink += ledhelpers::validate_led_map(map, led_count).valid ? 1 : 0;
+  const auto t1 = Clock::now();
+  if (sink != (size_t) reps) std::fprintf(stderr, "validate_led_map rejected a bench map\n");
+  return elapsed_ns(t0, t1) / reps;
+}
+
+const char *ease_name(EaseProfile ease) {
+  switch (ease) {
+    case EaseProfile::Linear:
+      return "linear";
+    case EaseProfile::QuintInOut:
+      return "quint";
+    default:
+      return "cubic";
+  }
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  int frames = 600;
+  const char *filter = nullptr;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--frames") && i + 1 < argc) frames = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--filter") && i + 1 < argc) filter = argv[++i];
+    else {
+      std::fprintf(stderr, "usage: %s [--frames N] [--filter SUBSTRING]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  const std::vector<MapCase> maps = bench_maps();
+
+  std::printf("%-5s %-4s %-5s %-6s %-6s %12s %10s %10s\n", "map", "plan", "snake", "wobble", "ease", "ns/frame",
+              "ns/LED", "writes/f");
+  for (const auto &mc : maps) {
+    for (FlowMode flow : {FlowMode::Fill, FlowMode::Off}) {
+      for (bool snake : {false, true}) {
+        for (bool wobble : {false, true}) {
+          for (EaseProfile ease : {EaseProfile::Linear, EaseProfile::CubicInOut, EaseProfile::QuintInOut}) {
+            char label[96];
+            std::snprintf(label, sizeof(label), "%s %s %s %s %s", mc.name, flow == FlowMode::Fill ? "fill" : "off",
+                          snake ? "snake" : "-", wobble ? "wobble" : "-", ease_name(ease));
+            if (filter && !std::strstr(label, filter)) continue;
+            const Result r = run_plan(mc.map, mc.leds, flow, snake, wobble, ease, frames);
+            std::printf("%-5s %-4s %-5s %-6s %-6s %12.0f %10.2f %10.1f\n", mc.name,
+                        flow == FlowMode::Fill ? "fill" : "off", snake ? "on" : "off", wobble ? "on" : "off",
+                        ease_name(ease), r.ns_per_frame, r.ns_per_led, r.writes_per_frame);
+          }
+        }
+      }
+    }
+  }
+
+  std::printf("\n%-5s %-16s %12s %10s\n", "map", "full repaint", "ns/frame", "ns/LED");
+  for (const auto &mc : maps) {
+    if (filter && !std::strstr(mc.name, filter)) continue;
+    for (bool wobble : {false, true}) {
+      const double ns = run_transition(mc.map, mc.leds, wobble, frames);
+      std::printf("%-5s %-16s %12.0f %10.2f\n", mc.name, wobble ? "wobble" : "solid", ns, ns / mc.leds);
+    }
+  }
+
+  std::printf("\n%-5s %-16s %12s %12s %12s\n", "map", "async render", "sync ns/f", "present ns/f", "submit ns/f");
+  for (const auto &mc : maps) {
+    if (filter && !std::strstr(mc.name, filter)) continue;
+    const AsyncResult r = run_async(mc.map, mc.leds, frames);
+    std::printf("%-5s %-16s %12.0f %12.0f %12.0f\n", mc.name, "lit wobble", r.sync_ns, r.present_ns, r.submit_ns);
+  }
+
+  std::printf("\n%-5s %-16s %12s %12s\n", "map", "sequence", "ms to dark", "retrigger +");
+  for (const auto &mc : maps) {
+    if (filter && !std::strstr(mc.name, filter)) continue;
+    for (bool async_render : {false, true}) {
+      const SequenceResult r = run_sequence(mc.map, mc.leds, async_render);
+      std::printf("%-5s %-16s %12u %12u\n", mc.name, async_render ? "async" : "sync", r.dark_ms, r.retrigger_ms);
+    }
+  }
+
+  std::printf("\n%-5s %-16s %12s %12s\n", "map", "composite", "ms to dark", "ns/frame");
+  for (const auto &mc : maps) {
+    if (filter && !std::strstr(mc.name, filter)) continue;
+    for (bool async_render : {false, true}) {
+      const CompositeResult r = run_composite(mc.map, mc.leds, async_render);
+      std::printf("%-5s %-16s %12u %12.0f\n", mc.name, async_render ? "async" : "sync", r.dark_ms, r.frame_ns);
+    }
+  }
+
+  std::printf("\n%-5s %-16s %10s %10s %12s %12s\n", "map", "layers", "fill ms", "meet ms", "fill ns/f", "meet ns/f");
+  for (const auto &mc : maps) {
+    if (filter && !std::strstr(mc.name, filter)) continue;
+    for (bool async_render : {false, true}) {
+      const LayerResult r = run_layers(mc.map, mc.leds, async_render);
+      std::printf("%-5s %-16s %10u %10u %12.0f %12.0f\n", mc.name, async_render ? "async" : "sync", r.fill_ms,
+                  r.meet_ms, r.fill_ns, r.meet_ns);
+    }
+  }
+
+  std::printf("\n%-5s %-16s %10s %10s %10s %10s %10s %10s\n", "map", "power budget", "budget mA", "peak mA",
+              "settled mA", "estimate", "free ns/f", "ns/f");
+  for (const auto &mc : maps) {
+    if (filter && !std::strstr(mc.name, filter)) continue;
+    for (bool async_render : {false, true}) {
+      const PowerResult r = run_power(mc.map, mc.leds, async_render);
+      std::printf("%-5s %-16s %10.0f %10.0f %10.0f %10.0f %10.0f %10.0f\n", mc.name, async_render ? "async" : "sync",
+                  r.budget_ma, r.peak_ma, r.settled_ma, r.estimate_ma, r.free_ns, r.limited_ns);
+    }
+  }
+
+  std::printf("\n%-5s %-16s %10s %12s\n", "map", "row heads", "fill ms", "ns/frame");
+  for (const auto &mc : maps) {
+    if (filter && !std::strstr(mc.name, filter)) continue;
+    for (const auto &hc : kHeadCases) {
+      const HeadResult r = run_heads(mc.map, mc.leds, hc);
+      std::printf("%-5s %-16s %10u %12.0f\n", mc.name, hc.name, r.fill_ms, r.ns_per_frame);
+    }
+  }
+
+  std::printf("\n%-5s %-16s %12s %12s\n", "map", "trigger", "from off us", "preempt us");
+  for (const auto &mc : maps) {
+    if (filter && !std::strstr(mc.name, filter)) continue;
+    for (bool async_render : {false, true}) {
+      const TriggerResult r = run_trigger(mc.map, mc.leds, async_render, 5);
+      std::printf("%-5s %-16s %12.0f %12.0f\n", mc.name, async_render ? "async" : "sync", r.from_off_us,
+                  r.preempt_us);
+    }
+  }
+
+  std::printf("\n%-5s %-16s %12s %12s\n", "map", "map swap", "set_map us", "frame ns");
+  for (const auto &mc : maps) {
+    if (filter && !std::strstr(mc.name, filter)) continue;
+    for (bool async_render : {false, true}) {
+      const SwapResult r = run_swap(mc.map, mc.leds, async_render);
+      std::printf("%-5s %-16s %12.1f %12.0f\n", mc.name, async_render ? "async" : "sync", r.set_map_us,
+                  r.swap_frame_ns);
+    }
+  }
+
+  std::printf("\n%-5s %-16s %12s %10s\n", "map", "validate_led_map", "ns/call", "ns/LED");
+  for (const auto &mc : maps) {
+    if (filter && !std::strstr(mc.name, filter)) continue;
+    const int leds = count_leds(mc.map);
+    const int reps = std::max(3, 200000 / leds);
+    for (int led_count : {mc.leds, 0}) {
+      const double ns = time_validate(mc.map, led_count, reps);
+      std::printf("%-5s %-16s %12.0f %10.2f\n", mc.name, led_count ? "led_count" : "no led_count", ns, ns / leds);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,162 @@
+// Host checks for the stairs_effects component: runs the scenarios in
+// scenarios.h over every bench map, sync and async, and fails (exit status 1)
+// if any of them misbehaved. Prints one line per failure and a summary.
+//
+//   make -C stairs-ctrl/bench check
+//   ./fcob_check --filter 244
+
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "rig.h"
+#include "scenarios.h"
+
+namespace {
+
+using namespace bench;
+
+int g_checks = 0;
+int g_failed = 0;
+
+// Counts a check and reports it when `ok` is false.
+void expect(bool ok, const char *map, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+void expect(bool ok, const char *map, const char *fmt, ...) {
+  g_checks++;
+  if (ok) return;
+  g_failed++;
+  std::printf("FAIL %-5s ", map);
+  va_list args;
+  va_start(args, fmt);
+  std::vprintf(fmt, args);
+  va_end(args);
+  std::printf("\n");
+}
+
+const char *mode_name(bool async_render) { return async_render ? "async" : "sync"; }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  const char *filter = nullptr;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--filter") && i + 1 < argc) filter = argv[++i];
+    else {
+      std::fprintf(stderr, "usage: %s [--filter SUBSTRING]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  for (const auto &mc : bench_maps()) {
+    if (filter && !std::strstr(mc.name, filter)) continue;
+    const char *m = mc.name;
+
+    const AsyncResult async = run_async(mc.map, mc.leds, 120);
+    expect(async.mismatched == 0, m, "async render: %d frames differ from the synchronous ones", async.mismatched);
+
+    for (bool async_render : {false, true}) {
+      const char *mode = mode_name(async_render);
+
+      const size_t allocs = count_apply_allocs(mc.map, mc.leds, async_render);
+      expect(allocs == 0, m, "%s effect cycles: apply() allocated %zu times", mode, allocs);
+
+      const SequenceResult seq = run_sequence(mc.map, mc.leds, async_render);
+      expect(seq.allocs == 0, m, "%s sequence: %zu allocations", mode, seq.allocs);
+      // The re-trigger lands on a frame boundary: allow a frame either way.
+      expect(std::abs((int) seq.retrigger_ms - 250) <= 16, m, "%s sequence: re-trigger extended the hold by %u ms",
+             mode, seq.retrigger_ms);
+
+      const CompositeResult comp = run_composite(mc.map, mc.leds, async_render);
+      expect(comp.cross_writes == 0, m, "%s composite: %d pixels written outside their segment", mode,
+             comp.cross_writes);
+      expect(comp.max_shows <= 1, m, "%s composite: %u shows in one apply()", mode, comp.max_shows);
+      expect(comp.allocs == 0, m, "%s composite: %zu allocations", mode, comp.allocs);
+
+      const LayerResult layers = run_layers(mc.map, mc.leds, async_render);
+      expect(layers.dark_leds == 0, m, "%s layers: %d mapped LEDs dark after meeting fills", mode,
+             layers.dark_leds);
+      expect(layers.allocs == 0, m, "%s layers: %zu allocations", mode, layers.allocs);
+
+      const PowerResult power = run_power(mc.map, mc.leds, async_render);
+      // Channel rounding may add a fraction of a percent to the estimate.
+      expect(power.peak_ma <= power.budget_ma * 1.01f, m, "%s power: peak %.0f mA over the %.0f mA budget", mode,
+             power.peak_ma, power.budget_ma);
+      expect(power.allocs == 0, m, "%s power: %zu allocations", mode, power.allocs);
+
+      const SwapResult swap = run_swap(mc.map, mc.leds, async_render);
+      expect(swap.stale_leds == 0, m, "%s map swap: %d LEDs only the old map had still lit", mode,
+             swap.stale_leds);
+      expect(swap.dark_leds == 0, m, "%s map swap: %d new-map LEDs dark", mode, swap.dark_leds);
+      expect(swap.allocs == 0, m, "%s map swap: %zu allocations after the swap", mode, swap.allocs);
+
+      const MapEditResult edit = run_map_edit(mc.map, mc.leds, async_render);
+      expect(edit.early_changes == 0, m, "%s map edit: %d LEDs changed before the reload", mode,
+             edit.early_changes);
+      expect(edit.stale_leds == 0, m, "%s map edit: %d LEDs of the dropped row lit after the reload", mode,
+             edit.stale_leds);
+      expect(edit.dark_leds == 0, m, "%s map edit: %d LEDs dark after the reload", mode, edit.dark_leds);
+
+      const TriggerResult trig = run_trigger(mc.map, mc.leds, async_render, 3);
+      expect(trig.dark_first_frames == 0, m, "%s trigger: %d triggers returned before painting", mode,
+             trig.dark_first_frames);
+    }
+
+    for (bool analytic : {false, true}) {
+      for (FlowMode next : {FlowMode::Fill, FlowMode::Off}) {
+        const char *plan = next == FlowMode::Fill ? "fill" : "off";
+        const char *timing = analytic ? "analytic" : "stepped";
+        const HandoffResult h = run_handoff(mc.map, mc.leds, next, analytic);
+        expect(h.max_row_changes <= 2, m, "%s %s over an off wave: a row changed %d LEDs on the handoff", timing,
+               plan, h.max_row_changes);
+        expect(h.wrong_leds == 0, m, "%s %s over an off wave: %d LEDs in the wrong state at the end", timing, plan,
+               h.wrong_leds);
+      }
+    }
+
+    const ShortStripResult short_strip = run_short_strip(mc.map, mc.leds);
+    expect(short_strip.solid_level == short_strip.strip_level, m,
+           "short strip: solid repaint level %u, the strip shows %u", short_strip.solid_level,
+           short_strip.strip_level);
+    expect(short_strip.stepped_level == short_strip.strip_level, m,
+           "short strip: per-pixel repaint level %u, the strip shows %u", short_strip.stepped_level,
+           short_strip.strip_level);
+
+    for (const auto &hc : kHeadCases) {
+      const HeadResult heads = run_heads(mc.map, mc.leds, hc);
+      expect(heads.dark_leds == 0, m, "row heads %s: %d mapped LEDs dark", hc.name, heads.dark_leds);
+      if (hc.row_ms == 0) continue;
+      const uint32_t want = (uint32_t) mc.map.size() * hc.row_ms;
+      for (bool analytic : {false, true}) {
+        // Up to a frame late to see the last row finish.
+        const uint32_t got = run_row_time(mc.map, mc.leds, hc, analytic);
+        expect(got >= want && got <= want + 16, m, "row heads %s, %s: lit in %u ms, rows x row_time is %u ms",
+               hc.name, analytic ? "analytic" : "stepped", got, want);
+      }
+    }
+  }
+
+  // Long rows whose sub-step is well under a frame.
+  if (!filter || std::strstr("long rows", filter)) {
+    const led_map_t map = make_stairs(4, 120);
+    const HeadCase hc{"single 1000ms", ledhelpers::HeadMode::Single, 1, 1000};
+    for (bool analytic : {false, true}) {
+      const uint32_t got = run_row_time(map, 480, hc, analytic);
+      expect(got >= 4000 && got <= 4016, "long", "%s row_time: lit in %u ms, rows x row_time is 4000 ms",
+             analytic ? "analytic" : "stepped", got);
+    }
+  }
+
+  // A strip longer than the layout can address still caps the indices.
+  if (!filter || std::strstr("validate", filter)) {
+    for (int idx : {(int) ledhelpers::kInvalidPhys - 1, (int) ledhelpers::kInvalidPhys, 70000}) {
+      const bool valid = ledhelpers::validate_led_map({{0, idx}}, 80000).valid;
+      expect(valid == (idx < ledhelpers::kInvalidPhys), "valid", "validate_led_map %s index %d on an 80000-LED strip",
+             valid ? "accepted" : "rejected", idx);
+    }
+  }
+
+  std::printf("%d checks, %d failed\n", g_checks, g_failed);
+  return g_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,14 @@
+// Host stand-in for binary_sensor::BinarySensor.
+#pragma once
+
+namespace esphome {
+namespace binary_sensor {
+
+class BinarySensor {
+ public:
+  bool state{false};
+  void publish_state(bool value) { state = value; }
+};
+
+}  // namespace binary_sensor
+}  // namespace esphome
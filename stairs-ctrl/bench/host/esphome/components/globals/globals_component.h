@@ -0,0 +1,22 @@
+// Host stand-in for globals::GlobalsComponent.
+#pragma once
+
+#include <utility>
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace globals {
+
+template<typename T> class GlobalsComponent : public Component {
+ public:
+  GlobalsComponent() = default;
+  explicit GlobalsComponent(T initial) : value_(std::move(initial)) {}
+  T &value() { return value_; }
+
+ protected:
+  T value_{};
+};
+
+}  // namespace globals
+}  // namespace esphome
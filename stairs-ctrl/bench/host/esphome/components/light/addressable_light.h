@@ -0,0 +1,176 @@
+// Host stand-in for the AddressableLight / effect API surface used by
+// stairs_effects. Pixels live in a plain Color buffer owned by the subclass.
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "esphome/core/color.h"
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace light {
+
+class ESPColorView {
+ public:
+  explicit ESPColorView(Color *pixel) : pixel_(pixel) {}
+  ESPColorView &operator=(const Color &color) {
+    *pixel_ = color;
+    return *this;
+  }
+  Color get() const { return *pixel_; }
+
+ protected:
+  Color *pixel_;
+};
+
+class AddressableLight;
+
+class ESPRangeView {
+ public:
+  ESPRangeView(AddressableLight *parent, int32_t begin, int32_t end) : parent_(parent), begin_(begin), end_(end) {}
+  ESPRangeView &operator=(const Color &color);
+
+ protected:
+  AddressableLight *parent_;
+  int32_t begin_;
+  int32_t end_;
+};
+
+class LightOutput {
+ public:
+  virtual ~LightOutput() = default;
+};
+
+class AddressableLight : public LightOutput, public Component {
+ public:
+  virtual int32_t size() const = 0;
+  ESPColorView operator[](int32_t index) const { return this->get_view_internal(index); }
+  ESPRangeView range(int32_t from, int32_t to) { return ESPRangeView(this, from, to); }
+  void schedule_show() { shows_++; }
+  uint32_t shows() const { return shows_; }
+
+ protected:
+  virtual ESPColorView get_view_internal(int32_t index) const = 0;
+  uint32_t shows_{0};
+};
+
+inline ESPRangeView &ESPRangeView::operator=(const Color &color) {
+  for (int32_t i = begin_; i < end_; i++) (*parent_)[i] = color;
+  return *this;
+}
+
+struct LightColorValues {
+  float brightness{1.0f};
+  float state{1.0f};
+  float red{1.0f};
+  float green{1.0f};
+  float blue{1.0f};
+  float get_brightness() const { return brightness; }
+  float get_state() const { return state; }
+  bool is_on() const { return state != 0.0f; }
+};
+
+class LightState;
+class LightEffect;
+
+class LightCall {
+ public:
+  explicit LightCall(LightState *parent) : parent_(parent) {}
+  LightCall &set_state(bool state) {
+    state_ = state;
+    return *this;
+  }
+  LightCall &set_effect(const std::string &effect) {
+    effect_ = effect;
+    return *this;
+  }
+  LightCall &set_transition_length(uint32_t length) {
+    transition_length_ = length;
+    return *this;
+  }
+  void perform();
+
+ protected:
+  LightState *parent_;
+  bool state_{true};
+  uint32_t transition_length_{0};
+  std::string effect_;
+};
+
+class LightState {
+ public:
+  explicit LightState(LightOutput *output = nullptr) : output_(output) {}
+  LightCall make_call() { return LightCall(this); }
+  const std::string &get_effect_name() const { return effect_name_; }
+  LightOutput *get_output() const { return output_; }
+  // Effects a call can switch to by name; calls with an effect name restart it.
+  void add_effects(const std::vector<LightEffect *> &effects) {
+    for (auto *effect : effects) effects_.push_back(effect);
+  }
+  LightEffect *get_active_effect() const { return active_effect_; }
+
+  LightColorValues current_values;
+  LightColorValues remote_values;
+
+ protected:
+  friend class LightCall;
+  LightOutput *output_;
+  std::string effect_name_;
+  std::vector<LightEffect *> effects_;
+  LightEffect *active_effect_{nullptr};
+};
+
+class LightEffect {
+ public:
+  explicit LightEffect(const char *name) : name_(name) {}
+  virtual ~LightEffect() = default;
+  virtual void start() {}
+  virtual void start_internal() { this->start(); }
+  virtual void stop() {}
+  virtual void apply() = 0;
+  virtual void init() {}
+  void init_internal(LightState *state) {
+    state_ = state;
+    this->init();
+  }
+  const std::string &get_name() const { return name_; }
+
+ protected:
+  LightState *state_{nullptr};
+  std::string name_;
+};
+
+class AddressableLightEffect : public LightEffect {
+ public:
+  explicit AddressableLightEffect(const char *name) : LightEffect(name) {}
+  void apply() override {
+    // Brightness is applied by the output, not baked into the effect color.
+    const auto &values = this->state_->remote_values;
+    this->apply(*this->get_addressable_(),
+                Color((uint8_t) (values.red * 255), (uint8_t) (values.green * 255), (uint8_t) (values.blue * 255)));
+  }
+  virtual void apply(AddressableLight &it, const Color &current_color) = 0;
+
+ protected:
+  AddressableLight *get_addressable_() const { return (AddressableLight *) this->state_->get_output(); }
+};
+
+// Transitions are not modelled: every call lands immediately.
+inline void LightCall::perform() {
+  parent_->current_values.state = state_ ? 1.0f : 0.0f;
+  parent_->remote_values = parent_->current_values;
+  if (effect_.empty()) return;
+  parent_->effect_name_ = effect_;
+  for (auto *effect : parent_->effects_) {
+    if (effect->get_name() != effect_) continue;
+    if (parent_->active_effect_ != nullptr) parent_->active_effect_->stop();
+    parent_->active_effect_ = effect;
+    effect->start_internal();
+    break;
+  }
+}
+
+}  // namespace light
+}  // namespace esphome
@@ -0,0 +1,23 @@
+// Host stand-in for number::Number.
+#pragma once
+
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+namespace number {
+
+class Number {
+ public:
+  float state{0.0f};
+  void add_on_state_callback(std::function<void(float)> &&callback) { callback_.add(std::move(callback)); }
+  void publish_state(float value) {
+    state = value;
+    callback_.call(value);
+  }
+
+ protected:
+  CallbackManager<float> callback_;
+};
+
+}  // namespace number
+}  // namespace esphome
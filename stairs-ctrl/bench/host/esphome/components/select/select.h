@@ -0,0 +1,28 @@
+// Host stand-in for select::Select.
+#pragma once
+
+#include <string>
+
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+namespace select {
+
+class Select {
+ public:
+  std::string state;
+  const std::string &current_option() const { return state; }
+  void add_on_state_callback(std::function<void(std::string, size_t)> &&callback) {
+    callback_.add(std::move(callback));
+  }
+  void publish_state(const std::string &value) {
+    state = value;
+    callback_.call(value, 0);
+  }
+
+ protected:
+  CallbackManager<std::string, size_t> callback_;
+};
+
+}  // namespace select
+}  // namespace esphome
@@ -0,0 +1,14 @@
+// Host stand-in for sensor::Sensor.
+#pragma once
+
+namespace esphome {
+namespace sensor {
+
+class Sensor {
+ public:
+  float state{0.0f};
+  void publish_state(float value) { state = value; }
+};
+
+}  // namespace sensor
+}  // namespace esphome
@@ -0,0 +1,23 @@
+// Host stand-in for switch_::Switch.
+#pragma once
+
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+namespace switch_ {
+
+class Switch {
+ public:
+  bool state{false};
+  void add_on_state_callback(std::function<void(bool)> &&callback) { callback_.add(std::move(callback)); }
+  void publish_state(bool value) {
+    state = value;
+    callback_.call(value);
+  }
+
+ protected:
+  CallbackManager<bool> callback_;
+};
+
+}  // namespace switch_
+}  // namespace esphome
@@ -0,0 +1,16 @@
+// Host stand-in for text_sensor::TextSensor.
+#pragma once
+
+#include <string>
+
+namespace esphome {
+namespace text_sensor {
+
+class TextSensor {
+ public:
+  std::string state;
+  void publish_state(const std::string &value) { state = value; }
+};
+
+}  // namespace text_sensor
+}  // namespace esphome
@@ -0,0 +1,39 @@
+// Host stand-in for the Action / TEMPLATABLE_VALUE surface of
+// esphome/core/automation.h used by stairs_effects actions.
+#pragma once
+
+#include <functional>
+#include <utility>
+
+namespace esphome {
+
+template<typename T, typename... X> class TemplatableValue {
+ public:
+  TemplatableValue() = default;
+  TemplatableValue(T value) : value_(std::move(value)) {}  // NOLINT
+  template<typename F, typename = decltype(std::declval<F>()(std::declval<X>()...))>
+  TemplatableValue(F f) : f_(std::move(f)) {}  // NOLINT
+
+  T value(X... x) { return f_ ? f_(x...) : value_; }
+
+ protected:
+  T value_{};
+  std::function<T(X...)> f_;
+};
+
+#define TEMPLATABLE_VALUE_(type, name) \
+ protected: \
+  TemplatableValue<type, Ts...> name##_{}; \
+\
+ public: \
+  template<typename V> void set_##name(V name) { this->name##_ = name; }
+
+#define TEMPLATABLE_VALUE(type, name) TEMPLATABLE_VALUE_(type, name)
+
+template<typename... Ts> class Action {
+ public:
+  virtual ~Action() = default;
+  virtual void play(Ts... x) = 0;
+};
+
+}  // namespace esphome
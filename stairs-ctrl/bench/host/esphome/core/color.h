@@ -0,0 +1,28 @@
+// Host stand-in for esphome::Color.
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+
+struct Color {
+  uint8_t r{0};
+  uint8_t g{0};
+  uint8_t b{0};
+  uint8_t w{0};
+
+  Color() = default;
+  Color(uint8_t red, uint8_t green, uint8_t blue) : r(red), g(green), b(blue) {}
+  Color(uint8_t red, uint8_t green, uint8_t blue, uint8_t white) : r(red), g(green), b(blue), w(white) {}
+
+  bool operator==(const Color &o) const { return r == o.r && g == o.g && b == o.b && w == o.w; }
+  bool operator!=(const Color &o) const { return !(*this == o); }
+
+  static const Color BLACK;
+  static const Color WHITE;
+};
+
+inline const Color Color::BLACK(0, 0, 0, 0);
+inline const Color Color::WHITE(255, 255, 255, 255);
+
+}  // namespace esphome
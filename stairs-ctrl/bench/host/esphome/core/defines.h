@@ -0,0 +1,7 @@
+// Host stand-in for the generated ESPHome defines.
+#pragma once
+
+#define USE_BINARY_SENSOR
+#define USE_SENSOR
+#define USE_TEXT_SENSOR
+#define USE_HOST
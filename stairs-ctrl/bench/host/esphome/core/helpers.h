@@ -0,0 +1,51 @@
+// Host stand-in for the subset of esphome/core/helpers.h used by stairs_effects.
+#pragma once
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace esphome {
+
+template<typename T> T clamp(T value, T lo, T hi) { return value < lo ? lo : (value > hi ? hi : value); }
+
+inline std::string str_sprintf(const char *fmt, ...) {
+  char buf[256];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+  return buf;
+}
+
+namespace host {
+// Virtual clock: when enabled, millis()/micros() return virtual_us so
+// benchmarks can drive animations at any frame rate.
+inline bool virtual_clock = false;
+inline uint64_t virtual_us = 0;
+}  // namespace host
+
+inline uint32_t micros() {
+  if (host::virtual_clock) return (uint32_t) host::virtual_us;
+  using namespace std::chrono;
+  return (uint32_t) duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+inline uint32_t millis() { return micros() / 1000u; }
+
+template<typename... Ts> class CallbackManager {
+ public:
+  void add(std::function<void(Ts...)> &&callback) { callbacks_.push_back(std::move(callback)); }
+  void call(Ts... args) {
+    for (auto &cb : callbacks_) cb(args...);
+  }
+
+ protected:
+  std::vector<std::function<void(Ts...)>> callbacks_;
+};
+
+}  // namespace esphome
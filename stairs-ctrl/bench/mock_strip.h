@@ -0,0 +1,27 @@
+// Minimal in-memory AddressableLight for host benchmarks.
+#pragma once
+
+#include <vector>
+
+#include "esphome/components/light/addressable_light.h"
+
+namespace bench {
+
+class MockStrip : public esphome::light::AddressableLight {
+ public:
+  explicit MockStrip(int leds) : pixels_(leds) {}
+  int32_t size() const override { return (int32_t) pixels_.size(); }
+  const std::vector<esphome::Color> &pixels() const { return pixels_; }
+  void clear() {
+    for (auto &px : pixels_) px = esphome::Color::BLACK;
+  }
+
+ protected:
+  esphome::light::ESPColorView get_view_internal(int32_t index) const override {
+    return esphome::light::ESPColorView(const_cast<esphome::Color *>(&pixels_[index]));
+  }
+
+  std::vector<esphome::Color> pixels_;
+};
+
+}  // namespace bench
@@ -0,0 +1,265 @@
+// Shared harness for the host bench and checks: bench maps, a counting
+// operator new, component rigs wired as the example YAML does, and
+// drive_frames(), the virtual-clock frame loop every scenario runs on.
+// Include from exactly one translation unit per binary (it defines the
+// replacement operator new).
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "fcob_helper.h"
+#include "mock_strip.h"
+
+using led_map_t = std::vector<std::vector<int>>;
+
+// Counting allocator for the allocation checks; counts only while armed.
+inline bool g_count_allocs = false;
+inline size_t g_allocs = 0;
+
+void *operator new(size_t size) {
+  if (g_count_allocs) g_allocs++;
+  if (void *p = std::malloc(size != 0 ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+// Not inlined: GCC otherwise pairs the inlined free() with the builtin
+// operator new and warns about a mismatch.
+__attribute__((noinline)) void operator delete(void *p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+inline double elapsed_ns(Clock::time_point t0, Clock::time_point t1) {
+  return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+}
+
+struct MapCase {
+  const char *name;
+  led_map_t map;
+  int leds;
+};
+
+// Serpentine stairs: rows of `width` LEDs, odd rows wired back to front.
+inline led_map_t make_stairs(int rows, int width) {
+  led_map_t map(rows);
+  int idx = 0;
+  for (int r = 0; r < rows; ++r) {
+    for (int i = 0; i < width; ++i) map[r].push_back(idx + (r % 2 ? width - 1 - i : i));
+    idx += width;
+  }
+  return map;
+}
+
+// The 244-LED install from example.yaml (7 treads, 29-39 LEDs each).
+inline led_map_t make_example_244() {
+  const int widths[] = {29, 31, 38, 39, 39, 34, 34};
+  led_map_t map;
+  int idx = 0;
+  for (int r = 0; r < 7; ++r) {
+    std::vector<int> row;
+    for (int i = 0; i < widths[r]; ++i) row.push_back(idx + (r % 2 ? widths[r] - 1 - i : i));
+    idx += widths[r];
+    map.push_back(row);
+  }
+  return map;
+}
+
+// The package map, the example install, serpentine stairs and a wall panel.
+inline std::vector<MapCase> bench_maps() {
+  std::vector<MapCase> maps;
+  maps.push_back({"21", {{0, 1, 2, 3, 4, 5}, {10, 9, 8, 7, 6}, {11, 12, 13, 14}, {20, 19, 18, 17, 16, 15}}, 21});
+  maps.push_back({"244", make_example_244(), 244});
+  maps.push_back({"2k", make_stairs(40, 50), 2000});
+  maps.push_back({"10k", make_stairs(100, 100), 10000});
+  maps.push_back({"wall", make_stairs(400, 8), 3200});
+  return maps;
+}
+
+inline int count_leds(const led_map_t &map) {
+  int n = 0;
+  for (const auto &row : map) n += (int) row.size();
+  return n;
+}
+
+// Mapped LEDs the strip shows dark.
+inline int dark_leds(const MockStrip &strip, const led_map_t &map) {
+  int n = 0;
+  for (const auto &row : map) {
+    for (int idx : row) {
+      const esphome::Color px = strip.pixels()[idx];
+      if ((px.r | px.g | px.b) == 0) n++;
+    }
+  }
+  return n;
+}
+
+// Virtual clock at 1 s for the scope, so millis() starts away from zero.
+struct VirtualClock {
+  VirtualClock() {
+    esphome::host::virtual_clock = true;
+    esphome::host::virtual_us = 1000000;
+  }
+  ~VirtualClock() { esphome::host::virtual_clock = false; }
+  VirtualClock(const VirtualClock &) = delete;
+  VirtualClock &operator=(const VirtualClock &) = delete;
+};
+
+// Component with a Fill Up / Off Down pair sharing one set of controls, as
+// the example YAML wires them.
+struct EffectRig {
+  esphome::globals::GlobalsComponent<led_map_t> map_global;
+  esphome::stairs_effects::StairsEffectsComponent component;
+  esphome::number::Number per_led, fade, threshold, amp, freq;
+  esphome::switch_::Switch snake, wobble;
+  esphome::select::Select easing;
+  esphome::stairs_effects::StairsFillUpEffect fill{&component, "Fill"};
+  esphome::stairs_effects::StairsOffDownEffect off{&component, "Off"};
+  MockStrip strip;
+  esphome::light::LightState state{&strip};
+
+  EffectRig(const led_map_t &map, int leds, bool async_render) : map_global(map), strip(leds) {
+    component.set_led_map(&map_global);
+    component.set_led_count(leds);
+    component.set_async_render(async_render);
+    per_led.state = 6;
+    fade.state = 3;
+    threshold.state = 0.5f;
+    amp.state = 6;
+    freq.state = 12;
+    easing.state = "Cubic InOut";
+    for (esphome::stairs_effects::StairsBaseEffect *effect : {(esphome::stairs_effects::StairsBaseEffect *) &fill,
+                                                              (esphome::stairs_effects::StairsBaseEffect *) &off}) {
+      effect->set_per_led_number(&per_led);
+      effect->set_fade_steps_number(&fade);
+      effect->set_row_threshold_number(&threshold);
+      effect->set_snake_switch(&snake);
+      effect->set_wobble_switch(&wobble);
+      effect->set_wobble_strength_number(&amp);
+      effect->set_wobble_frequency_number(&freq);
+      effect->set_easing_select(&easing);
+    }
+  }
+  // Mirrors codegen order: effects init with the light, then component setup.
+  void setup() {
+    state.add_effects({&fill, &off});
+    fill.init_internal(&state);
+    off.init_internal(&state);
+    component.setup();
+  }
+  void apply_frame() { state.get_active_effect()->apply(); }
+  void loop() { component.loop(); }
+  void wait_idle() {
+    if (auto *renderer = component.async_renderer()) renderer->wait_idle();
+  }
+  bool running() { return !component.tracker().finished(); }
+};
+
+// Two flights (lower/upper halves of the map) plus a tail of unmapped LEDs on
+// one strip, driven by StairsCompositeEffect.
+struct CompositeRig {
+  static constexpr int kTail = 16;
+  esphome::globals::GlobalsComponent<led_map_t> lower_map, upper_map;
+  esphome::stairs_effects::StairsEffectsComponent lower, upper;
+  esphome::number::Number per_led, fade, threshold, amp, freq;
+  esphome::switch_::Switch snake, wobble;
+  esphome::select::Select easing;
+  esphome::stairs_effects::StairsCompositeEffect composite{"Both flights"};
+  esphome::stairs_effects::StairsSegmentEffect lower_seg{&lower, "Both flights", ledhelpers::FlowMode::Off,
+                                                         ledhelpers::RowOrder::BottomToTop};
+  esphome::stairs_effects::StairsSegmentEffect upper_seg{&upper, "Both flights", ledhelpers::FlowMode::Off,
+                                                         ledhelpers::RowOrder::BottomToTop};
+  MockStrip strip;
+  esphome::light::LightState state{&strip};
+
+  CompositeRig(const led_map_t &map, int leds, bool async_render)
+      : lower_map(led_map_t(map.begin(), map.begin() + map.size() / 2)),
+        upper_map(led_map_t(map.begin() + map.size() / 2, map.end())),
+        strip(leds + kTail) {
+    per_led.state = 6;
+    fade.state = 3;
+    threshold.state = 0.5f;
+    easing.state = "Cubic InOut";
+    lower.set_led_map(&lower_map);
+    upper.set_led_map(&upper_map);
+    for (auto *component : {&lower, &upper}) {
+      component->set_led_count(leds + kTail);
+      component->set_async_render(async_render);
+    }
+    for (auto *segment : {&lower_seg, &upper_seg}) {
+      segment->set_per_led_number(&per_led);
+      segment->set_fade_steps_number(&fade);
+      segment->set_row_threshold_number(&threshold);
+      segment->set_snake_switch(&snake);
+      segment->set_wobble_switch(&wobble);
+      segment->set_wobble_strength_number(&amp);
+      segment->set_wobble_frequency_number(&freq);
+      segment->set_easing_select(&easing);
+      composite.add_segment(segment);
+    }
+  }
+  void setup() {
+    state.add_effects({&composite});
+    composite.init_internal(&state);
+    lower.setup();
+    upper.setup();
+  }
+  void apply_frame() { composite.apply(); }
+  void loop() {
+    lower.loop();
+    upper.loop();
+  }
+  void wait_idle() {
+    for (auto *component : {&lower, &upper}) {
+      if (auto *renderer = component->async_renderer()) renderer->wait_idle();
+    }
+  }
+};
+
+struct FrameStats {
+  int frames{0};
+  uint32_t elapsed_ms{0};  // virtual time since drive_frames() started
+  double apply_ns{0.0};    // apply_frame() time summed over the frames
+  double last_ns{0.0};     // apply_frame() time of the last frame
+  double mean_ns() const { return apply_ns / (frames > 0 ? frames : 1); }
+};
+
+// Step `rig` on the virtual 16 ms clock (see VirtualClock) until
+// `until(stats)` holds after a frame, or for ten virtual minutes at most.
+// `per_frame(stats)` runs ahead of each frame, once the clock has moved on,
+// for scripted events and for reading the previous frame off the strip.
+// Each frame is the light's apply_frame() then the components' loop(), as
+// ESPHome runs them. Both count towards allocations, only apply_frame()
+// towards the time; the worker is drained outside both, as the frame interval
+// would on a device.
+template<typename Rig, typename Until, typename PerFrame>
+FrameStats drive_frames(Rig &rig, Until until, PerFrame per_frame) {
+  FrameStats stats;
+  const uint32_t start_ms = esphome::millis();
+  do {
+    esphome::host::virtual_us += 16000;
+    stats.elapsed_ms = esphome::millis() - start_ms;
+    per_frame(stats);
+    g_count_allocs = true;
+    const auto t0 = Clock::now();
+    rig.apply_frame();
+    const auto t1 = Clock::now();
+    rig.loop();
+    g_count_allocs = false;
+    stats.last_ns = elapsed_ns(t0, t1);
+    stats.apply_ns += stats.last_ns;
+    stats.frames++;
+    rig.wait_idle();
+  } while (!until(stats) && stats.elapsed_ms < 600000);
+  return stats;
+}
+
+template<typename Rig, typename Until> FrameStats drive_frames(Rig &rig, Until until) {
+  return drive_frames(rig, until, [](const FrameStats &) {});
+}
+
+}  // namespace bench
@@ -0,0 +1,598 @@
+// Effect scenarios shared by the bench (which reports their timings) and the
+// checks (which assert on what they left on the strip). Each returns plain
+// numbers and never decides pass or fail itself.
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <thread>
+
+#include "rig.h"
+
+namespace bench {
+
+using esphome::Color;
+using ledhelpers::FlowMode;
+using ledhelpers::RowOrder;
+
+struct AsyncResult {
+  double sync_ns;     // render_frame() in the loop
+  double present_ns;  // copying the worker's frame onto the strip
+  double submit_ns;   // queueing the next frame (on a single-CPU host this
+                      // includes the worker preempting the loop)
+  int mismatched;     // frames whose strip differs from the synchronous one
+};
+
+// Wobble on a fully lit strip (every lit pixel changes each frame), rendered in
+// the loop and through AsyncRenderer side by side. The worker is drained
+// between frames outside the timed region, as the frame interval would be on
+// a device.
+inline AsyncResult run_async(const led_map_t &map, int leds, int frames) {
+  MockStrip sync_strip(leds), async_strip(leds);
+  ledhelpers::FcobProgressTracker sync_tracker, async_tracker;
+  ledhelpers::AsyncRenderer renderer;
+  renderer.canvas().resize(leds);
+  ledhelpers::RuntimeConfig cfg;
+  cfg.per_led_ms = 1;
+  cfg.analytic_timing = true;
+  cfg.wobble_enabled = true;
+  cfg.wobble_amp_deg = 6.0f;
+  cfg.wobble_freq_deg = 12.0f;
+  cfg.derive();
+  cfg.version = ledhelpers::next_config_version();
+  const Color base(255, 170, 90);
+  uint32_t now_ms = 0;
+  for (auto *tracker : {&sync_tracker, &async_tracker}) {
+    tracker->bind_map(&map);
+    tracker->start_effect({FlowMode::Fill, RowOrder::BottomToTop}, false);
+  }
+  while (!sync_tracker.finished()) {
+    now_ms += 1000;
+    sync_tracker.render_frame(sync_strip, cfg, base, now_ms);
+    async_tracker.render_frame(renderer.canvas(), cfg, base, now_ms);
+  }
+  renderer.canvas().present(async_strip);
+
+  renderer.start(&async_tracker);
+  double sync_ns = 0, present_ns = 0, submit_ns = 0;
+  int mismatched = 0;
+  // One extra iteration presents the last submitted frame.
+  for (int f = 0; f <= frames; ++f) {
+    now_ms += 16;
+    auto t0 = Clock::now();
+    renderer.canvas().present(async_strip);
+    auto t1 = Clock::now();
+    present_ns += elapsed_ns(t0, t1);
+    // async_strip now shows the frame sync_strip still holds.
+    if (sync_strip.pixels() != async_strip.pixels()) mismatched++;
+    if (f == frames) break;
+    t0 = Clock::now();
+    renderer.submit(cfg, base, now_ms);
+    t1 = Clock::now();
+    submit_ns += elapsed_ns(t0, t1);
+    t0 = Clock::now();
+    sync_tracker.render_frame(sync_strip, cfg, base, now_ms);
+    t1 = Clock::now();
+    sync_ns += elapsed_ns(t0, t1);
+    renderer.wait_idle();
+  }
+  renderer.stop();
+  return {sync_ns / frames, present_ns / frames, submit_ns / frames, mismatched};
+}
+
+// Heap allocations made by apply() + loop() over full effect cycles after
+// setup(): fill with every control changed mid-run (a custom easing name too
+// long for the small-string buffer included), then an off plan taking over.
+inline size_t count_apply_allocs(const led_map_t &map, int leds, bool async_render) {
+  EffectRig rig(map, leds, async_render);
+  auto &component = rig.component;
+  component.add_cubic_bezier_easing("Custom bench easing curve", 0.42f, 0.0f, 1.0f, 1.0f);
+  esphome::sensor::Sensor apply_avg, leds_written, heap;
+  component.set_apply_time_avg_sensor(&apply_avg);
+  component.set_leds_written_sensor(&leds_written);
+  component.set_tracker_heap_sensor(&heap);
+  component.set_stats_enabled(true);
+  component.set_stats_interval(1000);
+  rig.setup();
+
+  VirtualClock clock;
+  g_allocs = 0;
+  for (int cycle = 0; cycle < 2; ++cycle) {
+    rig.state.make_call().set_effect("Fill").perform();
+    drive_frames(
+        rig, [](const FrameStats &s) { return s.frames == 400; },
+        [&](const FrameStats &s) {
+          if (s.frames == 100) rig.wobble.publish_state(!rig.wobble.state);
+          if (s.frames == 150) rig.easing.publish_state("Custom bench easing curve");
+          if (s.frames == 200) rig.snake.publish_state(!rig.snake.state);
+          if (s.frames == 250) rig.per_led.publish_state(cycle == 0 ? 4.0f : 6.0f);
+        });
+    rig.state.make_call().set_effect("Off").perform();
+    drive_frames(rig, [](const FrameStats &s) { return s.frames == 400; });
+  }
+  rig.off.stop();
+  return g_allocs;
+}
+
+struct TriggerResult {
+  double from_off_us;
+  double preempt_us;
+  int dark_first_frames;  // triggers whose first frame left the strip dark
+};
+
+// stairs_effects.trigger latency: Fill Up from a dark strip, then Off Down
+// taking over 40 frames into the fill, averaged over `reps` rounds. Runs on
+// the real clock, since the latency is what it measures.
+inline TriggerResult run_trigger(const led_map_t &map, int leds, bool async_render, int reps) {
+  EffectRig rig(map, leds, async_render);
+  esphome::sensor::Sensor latency;
+  rig.component.set_trigger_latency_sensor(&latency);
+  rig.setup();
+
+  auto lit = [&]() {
+    for (const auto &px : rig.strip.pixels()) {
+      if (px.r | px.g | px.b) return true;
+    }
+    return false;
+  };
+  TriggerResult r{0.0, 0.0, 0};
+  for (int rep = 0; rep < reps; ++rep) {
+    rig.component.tracker().reset();
+    rig.strip.clear();
+    rig.state.make_call().set_state(false).perform();
+
+    rig.component.trigger(FlowMode::Fill, RowOrder::BottomToTop);
+    r.from_off_us += rig.component.trigger_latency_us();
+    if (!lit()) r.dark_first_frames++;
+    rig.component.loop();
+    for (int f = 0; f < 40; ++f) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      rig.state.get_active_effect()->apply();
+    }
+    rig.wait_idle();
+    rig.component.trigger(FlowMode::Off, RowOrder::TopToBottom);
+    r.preempt_us += rig.component.trigger_latency_us();
+    rig.component.loop();
+  }
+  rig.wait_idle();
+  r.from_off_us /= reps;
+  r.preempt_us /= reps;
+  return r;
+}
+
+struct SequenceResult {
+  uint32_t dark_ms;       // start_sequence() to the light switching itself off
+  uint32_t retrigger_ms;  // extra time when re-triggered 250 ms into the hold
+  size_t allocs;          // heap allocations in apply()/loop() while sequencing
+};
+
+// Fill up, hold 500 ms, off up, driven only by the effect frame loop.
+inline SequenceResult run_sequence(const led_map_t &map, int leds, bool async_render) {
+  auto run = [&](bool retrigger) {
+    EffectRig rig(map, leds, async_render);
+    rig.component.add_sequence("walk");
+    rig.component.add_sequence_plan(FlowMode::Fill, RowOrder::BottomToTop);
+    rig.component.add_sequence_hold(500);
+    rig.component.add_sequence_plan(FlowMode::Off, RowOrder::BottomToTop);
+    rig.setup();
+    VirtualClock clock;
+    rig.component.start_sequence("walk");
+    uint32_t hold_start_ms = 0;
+    bool retriggered = !retrigger;
+    const FrameStats s = drive_frames(
+        rig,
+        [&](const FrameStats &s) {
+          const auto &tracker = rig.component.tracker();
+          if (hold_start_ms == 0 && tracker.finished() && tracker.plan().flow == FlowMode::Fill)
+            hold_start_ms = s.elapsed_ms;
+          return !rig.state.remote_values.is_on();
+        },
+        [&](const FrameStats &s) {
+          if (!retriggered && hold_start_ms != 0 && s.elapsed_ms >= hold_start_ms + 250) {
+            rig.component.start_sequence("walk");
+            retriggered = true;
+          }
+        });
+    return s.elapsed_ms;
+  };
+  SequenceResult r{0, 0, 0};
+  g_allocs = 0;
+  r.dark_ms = run(false);
+  r.retrigger_ms = run(true) - r.dark_ms;
+  r.allocs = g_allocs;
+  return r;
+}
+
+struct CompositeResult {
+  uint32_t max_shows;  // schedule_show() calls in one apply()
+  int cross_writes;    // upper-flight or unmapped pixels touched while only the lower flight ran
+  uint32_t dark_ms;    // first trigger to the light switching itself off
+  double frame_ns;     // mean apply() time per frame
+  size_t allocs;
+};
+
+// Fill the lower flight, then the upper one, then turn both off.
+inline CompositeResult run_composite(const led_map_t &map, int leds, bool async_render) {
+  const Color sentinel(1, 2, 3);
+  CompositeRig rig(map, leds, async_render);
+  for (int i = 0; i < rig.strip.size(); ++i) rig.strip[i] = i < leds ? Color::BLACK : sentinel;
+  rig.setup();
+  std::vector<bool> lower_led(rig.strip.size(), false);
+  for (const auto &row : rig.lower_map.value()) {
+    for (int idx : row) lower_led[idx] = true;
+  }
+
+  CompositeResult r{0, 0, 0, 0.0, 0};
+  uint32_t shows = 0;
+  int frames = 0;
+  double total_ns = 0.0;
+  // Counts show() calls per frame on top of whatever ends the phase.
+  auto phase = [&](auto done) {
+    const FrameStats s = drive_frames(
+        rig,
+        [&](const FrameStats &) {
+          r.max_shows = std::max(r.max_shows, rig.strip.shows() - shows);
+          return done();
+        },
+        [&](const FrameStats &) { shows = rig.strip.shows(); });
+    frames += s.frames;
+    total_ns += s.apply_ns;
+    return s.elapsed_ms;
+  };
+  VirtualClock clock;
+  g_allocs = 0;
+  rig.lower.trigger(FlowMode::Fill, RowOrder::BottomToTop);
+  uint32_t elapsed = phase([&] {
+    return rig.lower.tracker().finished() && rig.lower.tracker().plan().flow == FlowMode::Fill;
+  });
+  elapsed += phase([] { return true; });  // async: present the last frame
+  for (int i = 0; i < rig.strip.size(); ++i) {
+    const Color px = rig.strip.pixels()[i];
+    if (i >= leds ? px != sentinel : (!lower_led[i] && (px.r | px.g | px.b))) r.cross_writes++;
+  }
+  rig.upper.trigger(FlowMode::Fill, RowOrder::BottomToTop);
+  elapsed += phase([&] { return rig.upper.tracker().finished(); });
+  rig.lower.trigger(FlowMode::Off, RowOrder::TopToBottom);
+  rig.upper.trigger(FlowMode::Off, RowOrder::TopToBottom);
+  elapsed += phase([&] { return !rig.state.remote_values.is_on(); });
+  r.dark_ms = elapsed;
+  for (int i = leds; i < rig.strip.size(); ++i) {
+    if (rig.strip.pixels()[i] != sentinel) r.cross_writes++;
+  }
+  r.frame_ns = total_ns / std::max(frames, 1);
+  r.allocs = g_allocs;
+  return r;
+}
+
+struct LayerResult {
+  uint32_t fill_ms;  // Fill Up alone until the tracker finishes
+  uint32_t meet_ms;  // same with a Fill Down layered on 100 ms in
+  double fill_ns;    // mean apply() time per frame
+  double meet_ns;
+  int dark_leds;  // mapped LEDs still dark after the layered run
+  size_t allocs;
+};
+
+// Someone entering at the top while a fill from the bottom is running: a
+// layered Fill Down meets the Fill Up in the middle, on the same tracker.
+inline LayerResult run_layers(const led_map_t &map, int leds, bool async_render) {
+  LayerResult r{0, 0, 0.0, 0.0, 0, 0};
+  g_allocs = 0;
+  for (bool layered : {false, true}) {
+    EffectRig rig(map, leds, async_render);
+    rig.setup();
+    VirtualClock clock;
+    rig.component.trigger(FlowMode::Fill, RowOrder::BottomToTop);
+    bool added = !layered;
+    const FrameStats s = drive_frames(
+        rig, [&](const FrameStats &) { return !rig.running(); },
+        [&](const FrameStats &s) {
+          if (added || s.elapsed_ms < 100) return;
+          rig.component.trigger_layer(FlowMode::Fill, RowOrder::TopToBottom, ledhelpers::LayerBlend::Max);
+          added = true;
+        });
+    (layered ? r.meet_ms : r.fill_ms) = s.elapsed_ms;
+    (layered ? r.meet_ns : r.fill_ns) = s.mean_ns();
+    rig.apply_frame();  // async: present the last frame
+    if (layered) r.dark_leds = dark_leds(rig.strip, map);
+  }
+  r.allocs = g_allocs;
+  return r;
+}
+
+struct PowerResult {
+  float budget_ma;
+  float peak_ma;      // highest strip current during the fill
+  float settled_ma;   // strip current once the fill has settled
+  float estimate_ma;  // what the component reports for the settled strip
+  double free_ns;     // mean apply() time per frame without a budget
+  double limited_ns;  // same with the budget
+  size_t allocs;
+};
+
+// Current drawn by the strip as painted, from its channel values.
+inline float strip_ma(const MockStrip &strip, float channel_ma) {
+  uint64_t sum = 0;
+  for (const Color &px : strip.pixels()) sum += px.r + px.g + px.b;
+  return (float) sum * channel_ma / 255.0f;
+}
+
+// Fill Up under a power budget of half what the fully lit map would draw.
+inline PowerResult run_power(const led_map_t &map, int leds, bool async_render) {
+  constexpr float kChannelMa = 20.0f;
+  const Color base(255, 255, 255);  // the light's color at full brightness
+  PowerResult r{0.0f, 0.0f, 0.0f, 0.0f, 0.0, 0.0, 0};
+  r.budget_ma = count_leds(map) * (base.r + base.g + base.b) * kChannelMa / 255.0f / 2.0f;
+  g_allocs = 0;
+  for (bool limited : {false, true}) {
+    EffectRig rig(map, leds, async_render);
+    if (limited) rig.component.set_power_budget(r.budget_ma, kChannelMa);
+    rig.setup();
+    VirtualClock clock;
+    rig.component.trigger(FlowMode::Fill, RowOrder::BottomToTop);
+    int settled = 0;
+    auto sample = [&] {
+      if (limited) r.peak_ma = std::max(r.peak_ma, strip_ma(rig.strip, kChannelMa));
+    };
+    // A few frames past the end, for the scale to settle and async to catch up.
+    const FrameStats s = drive_frames(
+        rig, [&](const FrameStats &) { return settled == 4; },
+        [&](const FrameStats &) {
+          sample();
+          if (!rig.running()) settled++;
+        });
+    sample();
+    (limited ? r.limited_ns : r.free_ns) = s.mean_ns();
+    if (limited) {
+      r.settled_ma = strip_ma(rig.strip, kChannelMa);
+      r.estimate_ma = rig.component.power_estimate_ma();
+    }
+  }
+  r.allocs = g_allocs;
+  return r;
+}
+
+struct HeadCase {
+  const char *name;
+  ledhelpers::HeadMode mode;
+  int count;
+  uint32_t row_ms;
+};
+
+inline const HeadCase kHeadCases[] = {
+    {"single", ledhelpers::HeadMode::Single, 1, 0},
+    {"both_ends", ledhelpers::HeadMode::BothEnds, 1, 0},
+    {"center", ledhelpers::HeadMode::Center, 1, 0},
+    {"spaced 4", ledhelpers::HeadMode::Spaced, 4, 0},
+    {"single 300ms", ledhelpers::HeadMode::Single, 1, 300},
+    {"both_ends 300ms", ledhelpers::HeadMode::BothEnds, 1, 300},
+};
+
+struct HeadResult {
+  uint32_t fill_ms;  // Fill Up until every row is lit
+  double ns_per_frame;
+  int dark_leds;  // mapped LEDs still dark afterwards
+};
+
+// Time to a fully lit staircase with the bench's plan timing, per head layout.
+inline HeadResult run_heads(const led_map_t &map, int leds, const HeadCase &hc) {
+  MockStrip strip(leds);
+  ledhelpers::FcobProgressTracker tracker;
+  tracker.set_row_heads(hc.mode, hc.count);
+  tracker.set_row_time(hc.row_ms);
+  tracker.bind_map(&map);
+  ledhelpers::RuntimeConfig cfg;
+  cfg.per_led_ms = 6;
+  cfg.fade_steps = 3;
+  cfg.row_threshold = 0.5f;
+  cfg.analytic_timing = true;
+  cfg.derive();
+  cfg.version = ledhelpers::next_config_version();
+  const Color base(255, 170, 90);
+  tracker.start_effect({FlowMode::Fill, RowOrder::BottomToTop}, false);
+  uint32_t now_ms = 0;
+  int frames = 0;
+  const auto t0 = Clock::now();
+  while (!tracker.finished() && now_ms < 600000) {
+    tracker.render_frame(strip, cfg, base, now_ms += 16);
+    frames++;
+  }
+  const auto t1 = Clock::now();
+  return {now_ms, elapsed_ns(t0, t1) / frames, dark_leds(strip, map)};
+}
+
+// Fill Up with every row paced to hc.row_ms and a threshold of 1, so each
+// row starts when the one below is lit and the fill should take rows x
+// row_ms, stepped or analytic. Returns the virtual ms from the first frame
+// (where the fill starts) to the one that shows it fully lit.
+inline uint32_t run_row_time(const led_map_t &map, int leds, const HeadCase &hc, bool analytic) {
+  MockStrip strip(leds);
+  ledhelpers::FcobProgressTracker tracker;
+  tracker.set_row_heads(hc.mode, hc.count);
+  tracker.set_row_time(hc.row_ms);
+  tracker.bind_map(&map);
+  ledhelpers::RuntimeConfig cfg;
+  cfg.per_led_ms = 6;
+  cfg.fade_steps = 3;
+  cfg.row_threshold = 1.0f;
+  cfg.analytic_timing = analytic;
+  cfg.derive();
+  cfg.version = ledhelpers::next_config_version();
+  const Color base(255, 170, 90);
+  tracker.start_effect({FlowMode::Fill, RowOrder::BottomToTop}, false);
+  const uint32_t first_ms = 16;
+  uint32_t now_ms = first_ms;
+  tracker.render_frame(strip, cfg, base, now_ms);
+  while (!tracker.finished() && now_ms < 600000) tracker.render_frame(strip, cfg, base, now_ms += 16);
+  return now_ms - first_ms;
+}
+
+struct HandoffResult {
+  int max_row_changes;  // most LEDs one row changed on the frame the new plan took over
+  int wrong_leds;       // mapped LEDs not fully lit (fill) or dark (off) at the end
+};
+
+// A fill with an off wave chasing it up, then a resumed plan taking over
+// mid-chase. Edges move one LED per frame here, so the takeover frame should
+// change at most two LEDs in any row.
+inline HandoffResult run_handoff(const led_map_t &map, int leds, FlowMode next, bool analytic) {
+  MockStrip strip(leds);
+  ledhelpers::FcobProgressTracker tracker;
+  tracker.bind_map(&map);
+  ledhelpers::RuntimeConfig cfg;
+  cfg.per_led_ms = 16;
+  cfg.analytic_timing = analytic;
+  cfg.derive();
+  cfg.version = ledhelpers::next_config_version();
+  const Color base(255, 255, 255);
+  uint32_t now_ms = 100;
+  tracker.start_effect({FlowMode::Fill, RowOrder::BottomToTop}, false);
+  for (int f = 0; f < 12; ++f) tracker.render_frame(strip, cfg, base, now_ms += 16);
+  tracker.add_layer({FlowMode::Off, RowOrder::BottomToTop}, ledhelpers::LayerBlend::Max);
+  for (int f = 0; f < 4; ++f) tracker.render_frame(strip, cfg, base, now_ms += 16);
+
+  const std::vector<Color> before = strip.pixels();
+  tracker.start_effect({next, RowOrder::BottomToTop}, true);
+  tracker.render_frame(strip, cfg, base, now_ms += 16);
+  HandoffResult r{0, 0};
+  for (const auto &row : map) {
+    int changes = 0;
+    for (int idx : row) changes += strip.pixels()[idx] != before[idx];
+    r.max_row_changes = std::max(r.max_row_changes, changes);
+  }
+  const uint32_t end_ms = now_ms + 600000;
+  while (!tracker.finished() && now_ms < end_ms) tracker.render_frame(strip, cfg, base, now_ms += 16);
+  const int dark = dark_leds(strip, map);
+  r.wrong_leds = next == FlowMode::Fill ? dark : count_leds(map) - dark;
+  return r;
+}
+
+struct ShortStripResult {
+  uint32_t strip_level;    // painted intensity of the mapped LEDs on the strip
+  uint32_t solid_level;    // output_level() after a solid full repaint
+  uint32_t stepped_level;  // output_level() after a per-pixel full repaint
+};
+
+// A lit map on a strip half its length: both full-repaint kernels must leave
+// the LEDs past the end out of the level the power estimate prices.
+inline ShortStripResult run_short_strip(const led_map_t &map, int leds) {
+  MockStrip strip(leds / 2);
+  ledhelpers::FcobProgressTracker tracker;
+  tracker.bind_map(&map);
+  ledhelpers::RuntimeConfig cfg;
+  cfg.per_led_ms = 1;
+  cfg.analytic_timing = true;
+  cfg.derive();
+  cfg.version = ledhelpers::next_config_version();
+  const Color base(255, 255, 255);
+  uint32_t now_ms = 100;
+  tracker.start_effect({FlowMode::Fill, RowOrder::BottomToTop}, false);
+  while (!tracker.finished()) tracker.render_frame(strip, cfg, base, now_ms += 1000);
+
+  ShortStripResult r{0, 0, 0};
+  tracker.invalidate_output();
+  tracker.render_frame(strip, cfg, base, now_ms += 16);
+  r.solid_level = tracker.output_level();
+  // Spaced heads take the per-pixel path; a whole row lit is the same pixels.
+  tracker.set_row_heads(ledhelpers::HeadMode::Spaced, 2);
+  tracker.render_frame(strip, cfg, base, now_ms += 16);
+  r.stepped_level = tracker.output_level();
+  for (const auto &row : map) {
+    for (int idx : row) {
+      if (idx < strip.size()) r.strip_level += strip.pixels()[idx].r;
+    }
+  }
+  return r;
+}
+
+struct SwapResult {
+  double set_map_us;     // parse, validate, compile and swap
+  double swap_frame_ns;  // first apply() on the new map
+  int stale_leds;        // LEDs only the old map had, still lit at the end
+  int dark_leds;         // LEDs of the new map still dark at the end
+  size_t allocs;
+};
+
+// stairs_effects.set_map 100 ms into Fill Up: the bottom row, lit by then,
+// goes and the other rows are rewired end to end, then the fill carries on
+// over the new map.
+inline SwapResult run_swap(const led_map_t &map, int leds, bool async_render) {
+  led_map_t next(map.begin() + 1, map.end());
+  std::string text = "{";
+  for (auto &row : next) {
+    std::reverse(row.begin(), row.end());
+    text += text.size() == 1 ? "{" : ",{";
+    for (size_t i = 0; i < row.size(); ++i) text += (i ? "," : "") + std::to_string(row[i]);
+    text += "}";
+  }
+  text += "}";
+
+  SwapResult r{0.0, 0.0, 0, 0, 0};
+  EffectRig rig(map, leds, async_render);
+  rig.setup();
+  VirtualClock clock;
+  rig.component.trigger(FlowMode::Fill, RowOrder::BottomToTop);
+  int swap_frame = -1;
+  size_t before_swap = 0;
+  g_allocs = 0;
+  drive_frames(
+      rig,
+      [&](const FrameStats &s) {
+        if (s.frames == swap_frame + 1) r.swap_frame_ns = s.last_ns;
+        return !rig.running();
+      },
+      [&](const FrameStats &s) {
+        if (swap_frame >= 0 || s.elapsed_ms < 100) return;
+        before_swap = g_allocs;
+        const auto t0 = Clock::now();
+        if (!rig.component.set_map(text)) std::fprintf(stderr, "set_map rejected a bench map\n");
+        const auto t1 = Clock::now();
+        r.set_map_us = elapsed_ns(t0, t1) / 1000.0;
+        swap_frame = s.frames;
+      });
+  rig.apply_frame();  // async: present the last frame
+  r.dark_leds = dark_leds(rig.strip, next);
+  std::vector<bool> in_next(leds, false);
+  for (const auto &row : next) {
+    for (int idx : row) in_next[idx] = true;
+  }
+  for (int idx : map.front()) {
+    const Color px = rig.strip.pixels()[idx];
+    if (!in_next[idx] && (px.r | px.g | px.b) != 0) r.stale_leds++;
+  }
+  // Frames before the swap may warm up; only the ones after it count.
+  r.allocs = g_allocs - before_swap;
+  return r;
+}
+
+struct MapEditResult {
+  int early_changes;  // LEDs that changed before the reload
+  int stale_leds;     // LEDs of the dropped row still lit after it
+  int dark_leds;      // LEDs of the edited map dark after it
+};
+
+// A lambda drops the bottom row of the globals map once Fill Up has lit the
+// strip: frames keep the compiled map until stairs_effects.set_map without
+// a map reloads it.
+inline MapEditResult run_map_edit(const led_map_t &map, int leds, bool async_render) {
+  MapEditResult r{0, 0, 0};
+  EffectRig rig(map, leds, async_render);
+  rig.setup();
+  VirtualClock clock;
+  rig.component.trigger(FlowMode::Fill, RowOrder::BottomToTop);
+  drive_frames(rig, [&](const FrameStats &) { return !rig.running(); });
+  rig.apply_frame();  // async: present the last frame
+  const std::vector<Color> before = rig.strip.pixels();
+  led_map_t &edited = rig.map_global.value();
+  edited.erase(edited.begin());
+  drive_frames(rig, [&](const FrameStats &s) { return s.frames >= 10; });
+  for (int i = 0; i < leds; ++i) r.early_changes += rig.strip.pixels()[i] != before[i];
+  if (!rig.component.set_map("")) std::fprintf(stderr, "set_map rejected an edited bench map\n");
+  drive_frames(rig, [&](const FrameStats &s) { return s.frames >= 2; });
+  const led_map_t dropped{map.front()};
+  r.dark_leds = dark_leds(rig.strip, edited);
+  r.stale_leds = count_leds(dropped) - dark_leds(rig.strip, dropped);
+  return r;
+}
+
+}  // namespace bench
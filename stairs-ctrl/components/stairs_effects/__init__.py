@@ -1,15 +1,24 @@
 """Stairs effects component exposing the FCOB helper."""
 
-from esphome.const import CONF_ID, CONF_NAME
+from esphome import automation
+from esphome.const import (
+    CONF_DIRECTION,
+    CONF_ID,
+    CONF_NAME,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    UNIT_MILLISECOND,
+)
 import esphome.codegen as cg
 import esphome.config_validation as cv
+from esphome.core import CORE
 from esphome.components import globals as globals_component
-from esphome.components import binary_sensor, light, number, select, switch, text_sensor
+from esphome.components import binary_sensor, light, number, select, sensor, switch, text_sensor
 from esphome.components.light.effects import register_addressable_effect
 from esphome.components.light.types import AddressableLightEffect
 
 CODEOWNERS = ["@timota"]
-AUTO_LOAD = ["binary_sensor", "text_sensor"]
+AUTO_LOAD = ["binary_sensor", "sensor", "text_sensor"]
 
 stairs_effects_ns = cg.esphome_ns.namespace("stairs_effects")
 
@@ -18,8 +27,36 @@ StairsFillUpEffect = stairs_effects_ns.class_("StairsFillUpEffect", AddressableL
 StairsFillDownEffect = stairs_effects_ns.class_("StairsFillDownEffect", AddressableLightEffect)
 StairsOffUpEffect = stairs_effects_ns.class_("StairsOffUpEffect", AddressableLightEffect)
 StairsOffDownEffect = stairs_effects_ns.class_("StairsOffDownEffect", AddressableLightEffect)
+StairsSegmentEffect = stairs_effects_ns.class_("StairsSegmentEffect", AddressableLightEffect)
+StairsCompositeEffect = stairs_effects_ns.class_("StairsCompositeEffect", AddressableLightEffect)
+TriggerAction = stairs_effects_ns.class_("TriggerAction", automation.Action)
+StartSequenceAction = stairs_effects_ns.class_("StartSequenceAction", automation.Action)
+StopSequenceAction = stairs_effects_ns.class_("StopSequenceAction", automation.Action)
+SetMapAction = stairs_effects_ns.class_("SetMapAction", automation.Action)
+
+ledhelpers_ns = cg.global_ns.namespace("ledhelpers")
+FlowMode = ledhelpers_ns.enum("FlowMode", is_class=True)
+RowOrder = ledhelpers_ns.enum("RowOrder", is_class=True)
+LayerBlend = ledhelpers_ns.enum("LayerBlend", is_class=True)
+TRIGGER_FLOWS = {"fill": FlowMode.Fill, "off": FlowMode.Off}
+TRIGGER_DIRECTIONS = {"up": RowOrder.BottomToTop, "down": RowOrder.TopToBottom}
+# Off flows always subtract when layered.
+LAYER_BLENDS = {"max": LayerBlend.Max, "add": LayerBlend.Add}
+HeadMode = ledhelpers_ns.enum("HeadMode", is_class=True)
+ROW_HEADS = {
+    "single": HeadMode.Single,
+    "both_ends": HeadMode.BothEnds,
+    "center": HeadMode.Center,
+    "spaced": HeadMode.Spaced,
+}
 
 CONF_LED_MAP_ID = "led_map_id"
+CONF_LED_MAP = "led_map"
+CONF_LED_MAP_OFFSETS_ID = "led_map_offsets_id"
+CONF_LED_MAP_PHYS_ID = "led_map_phys_id"
+CONF_LED_MAP_SNAKE_ID = "led_map_snake_id"
+CONF_FROM = "from"
+CONF_TO = "to"
 CONF_PER_LED_ID = "per_led_number_id"
 CONF_FADE_STEPS_ID = "fade_steps_number_id"
 CONF_ROW_THRESHOLD_ID = "row_threshold_number_id"
@@ -29,32 +66,365 @@ CONF_WOBBLE_STRENGTH_ID = "wobble_strength_number_id"
 CONF_WOBBLE_FREQ_ID = "wobble_frequency_number_id"
 CONF_EASING_SELECT_ID = "easing_select_id"
 CONF_SHUTDOWN_DELAY = "shutdown_delay"
+CONF_ANALYTIC_TIMING = "analytic_timing"
 CONF_COMPONENT_ID = "component_id"
 CONF_LED_COUNT = "led_count"
 CONF_MAP_VALID_BINARY_SENSOR = "map_valid_binary_sensor"
 CONF_MAP_STATUS_TEXT_SENSOR = "map_status_text_sensor"
+CONF_EASING_CURVES = "easing_curves"
+CONF_CUBIC_BEZIER = "cubic_bezier"
+CONF_EXPONENTIAL = "exponential"
+CONF_STATS_INTERVAL = "stats_interval"
+CONF_ASYNC_RENDER = "async_render"
+CONF_ROW_HEADS = "row_heads"
+CONF_HEAD_COUNT = "head_count"
+CONF_ROW_TIME = "row_time"
+CONF_APPLY_TIME_LAST_SENSOR = "apply_time_last_sensor"
+CONF_APPLY_TIME_AVG_SENSOR = "apply_time_avg_sensor"
+CONF_APPLY_TIME_MAX_SENSOR = "apply_time_max_sensor"
+CONF_FRAME_JITTER_SENSOR = "frame_jitter_sensor"
+CONF_LEDS_WRITTEN_SENSOR = "leds_written_sensor"
+CONF_DT_CLAMPS_SENSOR = "dt_clamps_sensor"
+CONF_TRACKER_HEAP_SENSOR = "tracker_heap_sensor"
+CONF_TRIGGER_LATENCY_SENSOR = "trigger_latency_sensor"
+CONF_FLOW = "flow"
+CONF_LAYER = "layer"
+CONF_SEQUENCES = "sequences"
+CONF_SEQUENCE = "sequence"
+CONF_STEPS = "steps"
+CONF_FILL = "fill"
+CONF_OFF = "off"
+CONF_HOLD = "hold"
+CONF_SEGMENTS = "segments"
+CONF_MAP = "map"
+CONF_POWER_BUDGET = "power_budget"
+CONF_CHANNEL_CURRENT = "channel_current"
+CONF_POWER_ESTIMATE_SENSOR = "power_estimate_sensor"
+
+UNIT_MICROSECOND = "µs"
+
+_APPLY_TIME_SCHEMA = sensor.sensor_schema(
+    unit_of_measurement=UNIT_MICROSECOND,
+    accuracy_decimals=0,
+    state_class=STATE_CLASS_MEASUREMENT,
+    entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    icon="mdi:timer-outline",
+)
+
+# Render diagnostics: config key -> (schema, C++ setter).
+RENDER_SENSORS = {
+    CONF_APPLY_TIME_LAST_SENSOR: (_APPLY_TIME_SCHEMA, "set_apply_time_last_sensor"),
+    CONF_APPLY_TIME_AVG_SENSOR: (_APPLY_TIME_SCHEMA, "set_apply_time_avg_sensor"),
+    CONF_APPLY_TIME_MAX_SENSOR: (_APPLY_TIME_SCHEMA, "set_apply_time_max_sensor"),
+    CONF_FRAME_JITTER_SENSOR: (
+        sensor.sensor_schema(
+            unit_of_measurement=UNIT_MILLISECOND,
+            accuracy_decimals=2,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon="mdi:chart-bell-curve",
+        ),
+        "set_frame_jitter_sensor",
+    ),
+    CONF_LEDS_WRITTEN_SENSOR: (
+        sensor.sensor_schema(
+            unit_of_measurement="LEDs",
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon="mdi:led-strip-variant",
+        ),
+        "set_leds_written_sensor",
+    ),
+    CONF_DT_CLAMPS_SENSOR: (
+        sensor.sensor_schema(
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon="mdi:speedometer-slow",
+        ),
+        "set_dt_clamps_sensor",
+    ),
+    CONF_TRACKER_HEAP_SENSOR: (
+        sensor.sensor_schema(
+            unit_of_measurement="B",
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon="mdi:memory",
+        ),
+        "set_tracker_heap_sensor",
+    ),
+}
+
+BUILTIN_EASINGS = ("Linear", "Cubic InOut", "Quint InOut")
+
+
+def _validate_cubic_bezier(value):
+    value = cv.All(cv.ensure_list(cv.float_), cv.Length(min=4, max=4))(value)
+    if not (0.0 <= value[0] <= 1.0 and 0.0 <= value[2] <= 1.0):
+        raise cv.Invalid("cubic_bezier x1/x2 must be within 0..1")
+    return value
+
+
+def _validate_easing_name(value):
+    value = cv.string_strict(value)
+    if value in BUILTIN_EASINGS:
+        raise cv.Invalid(f"'{value}' is a built-in easing name")
+    return value
+
+
+MAX_LED_INDEX = 0xFFFE  # 0xFFFF marks an invalid slot in the C++ layout
+
+
+def _led_map_row(value):
+    """A row is a list of LED indices or a {from, to} run (reversed when from > to)."""
+    if isinstance(value, dict):
+        value = cv.Schema(
+            {
+                cv.Required(CONF_FROM): cv.int_range(min=0, max=MAX_LED_INDEX),
+                cv.Required(CONF_TO): cv.int_range(min=0, max=MAX_LED_INDEX),
+            }
+        )(value)
+        start, end = value[CONF_FROM], value[CONF_TO]
+        step = 1 if end >= start else -1
+        return list(range(start, end + step, step))
+    return cv.ensure_list(cv.int_range(min=0, max=MAX_LED_INDEX))(value)
+
+
+def _led_index(text):
+    """A decimal LED index, as parse_led_map() reads it on the device."""
+    text = text.strip()
+    if not text or any(ch not in "0123456789" for ch in text):
+        raise ValueError(f"expected a decimal LED index, got '{text}'")
+    return int(text, 10)
+
+
+def _led_map_item(item):
+    """An item of the string form: an index, or a run `a-b` (reversed when a > b)."""
+    start, sep, end = item.partition("-")
+    if not sep:
+        return [_led_index(item)]
+    start, end = _led_index(start), _led_index(end)
+    step = 1 if end >= start else -1
+    return list(range(start, end + step, step))
+
+
+def _led_map(value):
+    """Accept YAML rows or the `{{0,1,2},{5,4,3}}` string used for globals maps."""
+    if isinstance(value, str):
+        text = value.strip()
+        if not (text.startswith("{") and text.endswith("}")):
+            raise cv.Invalid("led_map string must look like {{0,1,2},{5,4,3}}")
+        rows = []
+        for chunk in text[1:-1].split("}"):
+            chunk = chunk.strip().lstrip(",").strip()
+            if not chunk:
+                continue
+            if not chunk.startswith("{"):
+                raise cv.Invalid(f"led_map: unexpected '{chunk}'")
+            items = [item.strip() for item in chunk[1:].split(",") if item.strip()]
+            try:
+                rows.append([idx for item in items for idx in _led_map_item(item)])
+            except ValueError as err:
+                raise cv.Invalid(f"led_map: {err}") from err
+        value = rows
+    return [_led_map_row(row) for row in cv.ensure_list()(value)]
+
+
+def _led_map_text(value):
+    """A map for stairs_effects.set_map, kept as text; the device parses it again."""
+    value = cv.string_strict(value)
+    if any(ch not in "0123456789{},- \t\r\n" for ch in value):
+        raise cv.Invalid("map text takes decimal indices, runs like 0-9, commas and braces only")
+    _led_map(value)
+    return value
+
+
+def _validate_led_map(config):
+    """Build-time twin of ledhelpers::validate_led_map()."""
+    if CONF_LED_MAP not in config:
+        return config
+    rows = config[CONF_LED_MAP]
+    led_count = config[CONF_LED_COUNT]
+    path = [CONF_LED_MAP]
+    if not rows:
+        raise cv.Invalid("map has no rows", path)
+    seen = set()
+    for r, row in enumerate(rows):
+        if not row:
+            raise cv.Invalid(f"row {r} is empty", path)
+        for c, idx in enumerate(row):
+            if led_count > 0 and idx >= led_count:
+                raise cv.Invalid(f"row {r} col {c} index {idx} outside 0..{led_count - 1}", path)
+            if idx in seen:
+                raise cv.Invalid(f"duplicate index {idx} at row {r} col {c}", path)
+            seen.add(idx)
+    return config
+
+
+def _led_map_status(rows, led_count):
+    """Same OK summary validate_led_map() publishes for globals maps."""
+    leds = [idx for row in rows for idx in row]
+    summary = f"OK: rows={len(rows)} leds={len(leds)} range[{min(leds)}..{max(leds)}]"
+    if led_count > 0:
+        return f"{summary} total_leds={led_count}"
+    return f"{summary} (no led_count)"
+
+
+EASING_CURVE_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.Required(CONF_NAME): _validate_easing_name,
+            cv.Optional(CONF_CUBIC_BEZIER): _validate_cubic_bezier,
+            cv.Optional(CONF_EXPONENTIAL): cv.float_,
+        }
+    ),
+    cv.has_exactly_one_key(CONF_CUBIC_BEZIER, CONF_EXPONENTIAL),
+)
+
+SEQUENCE_STEP_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.Optional(CONF_FILL): cv.enum(TRIGGER_DIRECTIONS, lower=True),
+            cv.Optional(CONF_OFF): cv.enum(TRIGGER_DIRECTIONS, lower=True),
+            cv.Optional(CONF_HOLD): cv.All(
+                cv.positive_time_period_milliseconds, cv.Range(min=cv.TimePeriod(milliseconds=1))
+            ),
+        }
+    ),
+    cv.has_exactly_one_key(CONF_FILL, CONF_OFF, CONF_HOLD),
+)
+
+
+def _validate_sequence(value):
+    if CONF_HOLD in value[CONF_STEPS][0]:
+        raise cv.Invalid("a sequence must start with a fill or off step", [CONF_STEPS, 0])
+    return value
+
+
+SEQUENCE_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.Required(CONF_NAME): cv.string_strict,
+            cv.Required(CONF_STEPS): cv.All(cv.ensure_list(SEQUENCE_STEP_SCHEMA), cv.Length(min=1)),
+        }
+    ),
+    _validate_sequence,
+)
+
+
+def _unique_sequence_names(value):
+    names = [seq[CONF_NAME] for seq in value]
+    for i, name in enumerate(names):
+        if name in names[:i]:
+            raise cv.Invalid(f"duplicate sequence name '{name}'", [i, CONF_NAME])
+    return value
+
+
+def _async_render(value):
+    """Background rendering needs a second core (ESP32) or a host thread."""
+    value = cv.boolean(value)
+    if value and not (CORE.is_esp32 or CORE.is_host):
+        raise cv.Invalid("async_render is only supported on ESP32 and host builds")
+    return value
+
+
+def _validate_row_heads(config):
+    """head_count sets how many heads spaced rows get, and only those."""
+    spaced = config[CONF_ROW_HEADS] == "spaced"
+    if spaced and CONF_HEAD_COUNT not in config:
+        raise cv.Invalid("row_heads: spaced needs head_count", [CONF_HEAD_COUNT])
+    if not spaced and CONF_HEAD_COUNT in config:
+        raise cv.Invalid("head_count only applies to row_heads: spaced", [CONF_HEAD_COUNT])
+    return config
+
 
 COMPONENT_SCHEMA = cv.Schema(
     {
         cv.GenerateID(): cv.declare_id(StairsEffectsComponent),
-        cv.Required(CONF_LED_MAP_ID): cv.use_id(globals_component.GlobalsComponent),
+        cv.Optional(CONF_LED_MAP_ID): cv.use_id(globals_component.GlobalsComponent),
+        cv.Optional(CONF_LED_MAP): _led_map,
+        cv.GenerateID(CONF_LED_MAP_OFFSETS_ID): cv.declare_id(cg.uint32),
+        cv.GenerateID(CONF_LED_MAP_PHYS_ID): cv.declare_id(cg.uint16),
+        cv.GenerateID(CONF_LED_MAP_SNAKE_ID): cv.declare_id(cg.uint16),
         cv.Optional(CONF_LED_COUNT, default=0): cv.int_,
         cv.Optional(CONF_MAP_VALID_BINARY_SENSOR): binary_sensor.binary_sensor_schema(),
         cv.Optional(CONF_MAP_STATUS_TEXT_SENSOR): text_sensor.text_sensor_schema(),
+        cv.Optional(CONF_EASING_CURVES, default=[]): cv.ensure_list(EASING_CURVE_SCHEMA),
+        cv.Optional(CONF_STATS_INTERVAL, default="10s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_ASYNC_RENDER, default=False): _async_render,
+        cv.Optional(CONF_ROW_HEADS, default="single"): cv.enum(ROW_HEADS, lower=True),
+        cv.Optional(CONF_HEAD_COUNT): cv.int_range(min=2, max=64),
+        cv.Optional(CONF_ROW_TIME): cv.All(
+            cv.positive_time_period_milliseconds,
+            cv.Range(min=cv.TimePeriod(milliseconds=1), max=cv.TimePeriod(milliseconds=65535)),
+        ),
+        cv.Optional(CONF_SEQUENCES, default=[]): cv.All(
+            cv.ensure_list(SEQUENCE_SCHEMA), _unique_sequence_names
+        ),
+        cv.Optional(CONF_TRIGGER_LATENCY_SENSOR): sensor.sensor_schema(
+            unit_of_measurement=UNIT_MICROSECOND,
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon="mdi:motion-sensor",
+        ),
+        cv.Optional(CONF_POWER_BUDGET): cv.All(cv.current, cv.Range(min=0.001)),
+        cv.Optional(CONF_CHANNEL_CURRENT, default="20mA"): cv.All(cv.current, cv.Range(min=0.0001)),
+        cv.Optional(CONF_POWER_ESTIMATE_SENSOR): sensor.sensor_schema(
+            unit_of_measurement="mA",
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            icon="mdi:current-dc",
+        ),
     }
-).extend({})
+).extend({cv.Optional(key): schema for key, (schema, _) in RENDER_SENSORS.items()})
+
+CONFIG_SCHEMA = cv.ensure_list(
+    cv.All(
+        COMPONENT_SCHEMA,
+        cv.has_exactly_one_key(CONF_LED_MAP_ID, CONF_LED_MAP),
+        _validate_led_map,
+        _validate_row_heads,
+    )
+)
+
+
+def _emit_static_led_map(var, conf):
+    """Lay the map out in CSR form (as LedLayout::compile does) in flash."""
+    rows = conf[CONF_LED_MAP]
+    offsets, phys, snake = [0], [], []
+    for r, row in enumerate(rows):
+        phys.extend(row)
+        # Odd rows are pre-reversed for snake mode (row_reverse_forward_fill).
+        snake.extend(reversed(row) if r % 2 == 1 else row)
+        offsets.append(len(phys))
+    offsets_arr = cg.static_const_array(conf[CONF_LED_MAP_OFFSETS_ID], offsets)
+    phys_arr = cg.static_const_array(conf[CONF_LED_MAP_PHYS_ID], phys)
+    snake_arr = cg.static_const_array(conf[CONF_LED_MAP_SNAKE_ID], snake)
+    status = _led_map_status(rows, conf[CONF_LED_COUNT])
+    cg.add(var.set_static_led_map(offsets_arr, phys_arr, snake_arr, len(rows), status))
 
-CONFIG_SCHEMA = cv.ensure_list(COMPONENT_SCHEMA)
 
 async def to_code(config):
     for conf in config:
         var = cg.new_Pvariable(conf[CONF_ID])
         await cg.register_component(var, conf)
 
-        led_map_var = await cg.get_variable(conf[CONF_LED_MAP_ID])
-        cg.add(var.set_led_map(led_map_var))
+        if CONF_LED_MAP in conf:
+            _emit_static_led_map(var, conf)
+        else:
+            led_map_var = await cg.get_variable(conf[CONF_LED_MAP_ID])
+            cg.add(var.set_led_map(led_map_var))
 
         cg.add(var.set_led_count(conf[CONF_LED_COUNT]))
+        if conf[CONF_ASYNC_RENDER]:
+            cg.add(var.set_async_render(True))
+        if conf[CONF_ROW_HEADS] != "single":
+            cg.add(var.set_row_heads(conf[CONF_ROW_HEADS], conf.get(CONF_HEAD_COUNT, 1)))
+        if CONF_ROW_TIME in conf:
+            cg.add(var.set_row_time(conf[CONF_ROW_TIME].total_milliseconds))
 
         if conf.get(CONF_MAP_VALID_BINARY_SENSOR):
             sens = await binary_sensor.new_binary_sensor(conf[CONF_MAP_VALID_BINARY_SENSOR])
@@ -63,7 +433,47 @@ async def to_code(config):
         if conf.get(CONF_MAP_STATUS_TEXT_SENSOR):
             txt = await text_sensor.new_text_sensor(conf[CONF_MAP_STATUS_TEXT_SENSOR])
             cg.add(var.set_map_status_sensor(txt))
-BASE_EFFECT_SCHEMA = cv.Schema(
+
+        stats_enabled = False
+        for key, (_, setter) in RENDER_SENSORS.items():
+            if conf.get(key):
+                sens = await sensor.new_sensor(conf[key])
+                cg.add(getattr(var, setter)(sens))
+                stats_enabled = True
+        if stats_enabled:
+            cg.add(var.set_stats_enabled(True))
+            cg.add(var.set_stats_interval(conf[CONF_STATS_INTERVAL].total_milliseconds))
+
+        if conf.get(CONF_TRIGGER_LATENCY_SENSOR):
+            sens = await sensor.new_sensor(conf[CONF_TRIGGER_LATENCY_SENSOR])
+            cg.add(var.set_trigger_latency_sensor(sens))
+
+        # Amps in YAML, mA on the device; without a budget the sensor still estimates.
+        if CONF_POWER_BUDGET in conf or conf.get(CONF_POWER_ESTIMATE_SENSOR):
+            budget_ma = conf.get(CONF_POWER_BUDGET, 0.0) * 1000.0
+            cg.add(var.set_power_budget(budget_ma, conf[CONF_CHANNEL_CURRENT] * 1000.0))
+        if conf.get(CONF_POWER_ESTIMATE_SENSOR):
+            sens = await sensor.new_sensor(conf[CONF_POWER_ESTIMATE_SENSOR])
+            cg.add(var.set_power_estimate_sensor(sens))
+
+        for seq in conf[CONF_SEQUENCES]:
+            cg.add(var.add_sequence(seq[CONF_NAME]))
+            for step in seq[CONF_STEPS]:
+                if CONF_HOLD in step:
+                    cg.add(var.add_sequence_hold(step[CONF_HOLD].total_milliseconds))
+                elif CONF_FILL in step:
+                    cg.add(var.add_sequence_plan(FlowMode.Fill, step[CONF_FILL]))
+                else:
+                    cg.add(var.add_sequence_plan(FlowMode.Off, step[CONF_OFF]))
+
+        for curve in conf[CONF_EASING_CURVES]:
+            if CONF_CUBIC_BEZIER in curve:
+                x1, y1, x2, y2 = curve[CONF_CUBIC_BEZIER]
+                cg.add(var.add_cubic_bezier_easing(curve[CONF_NAME], x1, y1, x2, y2))
+            else:
+                cg.add(var.add_exponential_easing(curve[CONF_NAME], curve[CONF_EXPONENTIAL]))
+
+EFFECT_CONTROLS_SCHEMA = cv.Schema(
     {
         cv.Required(CONF_COMPONENT_ID): cv.use_id(StairsEffectsComponent),
         cv.Required(CONF_PER_LED_ID): cv.use_id(number.Number),
@@ -74,6 +484,41 @@ BASE_EFFECT_SCHEMA = cv.Schema(
         cv.Required(CONF_WOBBLE_STRENGTH_ID): cv.use_id(number.Number),
         cv.Required(CONF_WOBBLE_FREQ_ID): cv.use_id(number.Number),
         cv.Required(CONF_EASING_SELECT_ID): cv.use_id(select.Select),
+        cv.Optional(CONF_ANALYTIC_TIMING, default=False): cv.boolean,
+    }
+)
+
+BASE_EFFECT_SCHEMA = EFFECT_CONTROLS_SCHEMA.extend(
+    {
+        cv.Optional(CONF_SHUTDOWN_DELAY, default="50ms"): cv.positive_time_period_milliseconds,
+    }
+)
+
+# Segments start on `flow`/`direction`; triggers and sequences switch them.
+SEGMENT_SCHEMA = EFFECT_CONTROLS_SCHEMA.extend(
+    {
+        cv.GenerateID(): cv.declare_id(StairsSegmentEffect),
+        cv.Optional(CONF_DIRECTION, default="up"): cv.enum(TRIGGER_DIRECTIONS, lower=True),
+        cv.Optional(CONF_FLOW, default="fill"): cv.enum(TRIGGER_FLOWS, lower=True),
+    }
+)
+
+
+def _distinct_segment_components(value):
+    seen = set()
+    for i, segment in enumerate(value):
+        component_id = segment[CONF_COMPONENT_ID].id
+        if component_id in seen:
+            raise cv.Invalid(f"component '{component_id}' is already a segment", [i, CONF_COMPONENT_ID])
+        seen.add(component_id)
+    return value
+
+
+COMPOSITE_EFFECT_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_SEGMENTS): cv.All(
+            cv.ensure_list(SEGMENT_SCHEMA), cv.Length(min=1), _distinct_segment_components
+        ),
         cv.Optional(CONF_SHUTDOWN_DELAY, default="50ms"): cv.positive_time_period_milliseconds,
     }
 )
@@ -97,7 +542,9 @@ async def _configure_effect(effect_var, config):
     cg.add(effect_var.set_wobble_strength_number(wobble_strength))
     cg.add(effect_var.set_wobble_frequency_number(wobble_freq))
     cg.add(effect_var.set_easing_select(easing_sel))
-    cg.add(effect_var.set_shutdown_delay(config[CONF_SHUTDOWN_DELAY].total_milliseconds))
+    if CONF_SHUTDOWN_DELAY in config:
+        cg.add(effect_var.set_shutdown_delay(config[CONF_SHUTDOWN_DELAY].total_milliseconds))
+    cg.add(effect_var.set_analytic_timing(config[CONF_ANALYTIC_TIMING]))
 
 
 @register_addressable_effect(
@@ -138,3 +585,85 @@ async def stairs_effects_off_down_to_code(config, effect_id):
     effect = cg.new_Pvariable(effect_id, parent, config[CONF_NAME])
     await _configure_effect(effect, config)
     return effect
+
+
+@register_addressable_effect(
+    "stairs_effects.composite", StairsCompositeEffect, "Stairs Composite", COMPOSITE_EFFECT_SCHEMA
+)
+async def stairs_effects_composite_to_code(config, effect_id):
+    effect = cg.new_Pvariable(effect_id, config[CONF_NAME])
+    cg.add(effect.set_shutdown_delay(config[CONF_SHUTDOWN_DELAY].total_milliseconds))
+    for seg in config[CONF_SEGMENTS]:
+        parent = await cg.get_variable(seg[CONF_COMPONENT_ID])
+        segment = cg.new_Pvariable(seg[CONF_ID], parent, config[CONF_NAME], seg[CONF_FLOW], seg[CONF_DIRECTION])
+        await _configure_effect(segment, seg)
+        cg.add(effect.add_segment(segment))
+    return effect
+
+
+@automation.register_action(
+    "stairs_effects.trigger",
+    TriggerAction,
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.use_id(StairsEffectsComponent),
+            cv.Required(CONF_DIRECTION): cv.templatable(cv.enum(TRIGGER_DIRECTIONS, lower=True)),
+            cv.Optional(CONF_FLOW, default="fill"): cv.templatable(cv.enum(TRIGGER_FLOWS, lower=True)),
+            cv.Optional(CONF_LAYER): cv.enum(LAYER_BLENDS, lower=True),
+        }
+    ),
+)
+async def stairs_effects_trigger_to_code(config, action_id, template_arg, args):
+    parent = await cg.get_variable(config[CONF_ID])
+    var = cg.new_Pvariable(action_id, template_arg, parent)
+    direction = await cg.templatable(config[CONF_DIRECTION], args, RowOrder)
+    cg.add(var.set_order(direction))
+    flow = await cg.templatable(config[CONF_FLOW], args, FlowMode)
+    cg.add(var.set_flow(flow))
+    if CONF_LAYER in config:
+        cg.add(var.set_layer(config[CONF_LAYER]))
+    return var
+
+
+@automation.register_action(
+    "stairs_effects.start_sequence",
+    StartSequenceAction,
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.use_id(StairsEffectsComponent),
+            cv.Required(CONF_SEQUENCE): cv.string_strict,
+        }
+    ),
+)
+async def stairs_effects_start_sequence_to_code(config, action_id, template_arg, args):
+    parent = await cg.get_variable(config[CONF_ID])
+    return cg.new_Pvariable(action_id, template_arg, parent, config[CONF_SEQUENCE])
+
+
+@automation.register_action(
+    "stairs_effects.stop_sequence",
+    StopSequenceAction,
+    cv.Schema({cv.GenerateID(): cv.use_id(StairsEffectsComponent)}),
+)
+async def stairs_effects_stop_sequence_to_code(config, action_id, template_arg, args):
+    parent = await cg.get_variable(config[CONF_ID])
+    return cg.new_Pvariable(action_id, template_arg, parent)
+
+
+@automation.register_action(
+    "stairs_effects.set_map",
+    SetMapAction,
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.use_id(StairsEffectsComponent),
+            cv.Optional(CONF_MAP): cv.templatable(_led_map_text),
+        }
+    ),
+)
+async def stairs_effects_set_map_to_code(config, action_id, template_arg, args):
+    parent = await cg.get_variable(config[CONF_ID])
+    var = cg.new_Pvariable(action_id, template_arg, parent)
+    if CONF_MAP in config:
+        text = await cg.templatable(config[CONF_MAP], args, cg.std_string)
+        cg.add(var.set_map(text))
+    return var
@@ -2,13 +2,15 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <limits>
 #include <optional>
 #include <string>
-#include <unordered_set>
 #include <vector>
 
 #include "esphome/components/globals/globals_component.h"
@@ -19,14 +21,27 @@
 #ifdef USE_BINARY_SENSOR
 #include "esphome/components/binary_sensor/binary_sensor.h"
 #endif
+#ifdef USE_SENSOR
+#include "esphome/components/sensor/sensor.h"
+#endif
 #ifdef USE_TEXT_SENSOR
 #include "esphome/components/text_sensor/text_sensor.h"
 #endif
+#include "esphome/core/automation.h"
 #include "esphome/core/component.h"
 #include "esphome/core/defines.h"
 #include "esphome/core/helpers.h"
 #include "esphome/core/log.h"
 
+#if defined(USE_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#elif defined(USE_HOST)
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
 namespace esphome {
 namespace binary_sensor {
 class BinarySensor;
@@ -52,6 +67,7 @@ enum class EaseProfile {
   Linear,
   CubicInOut,
   QuintInOut,
+  Custom,  // table supplied by an easing_curves entry
 };
 
 enum class EffectFlavor {
@@ -61,6 +77,19 @@ enum class EffectFlavor {
   OffTopToBottom,
 };
 
+struct EaseTable {
+  // Easing curve baked to 256 steps: head intensity (0..255) for a sub-LED
+  // progress of k/255. Every profile costs the same lookup at runtime.
+  uint8_t lut[256];
+
+  static EaseTable from_profile(EaseProfile ease);
+  static EaseTable cubic_bezier(float x1, float y1, float x2, float y2);
+  static EaseTable exponential(float k);
+
+ private:
+  template<typename F> static EaseTable bake(F curve);
+};
+
 struct RuntimeConfig {
   // Per-frame knobs pulled from YAML controls.
   uint32_t per_led_ms{24};
@@ -68,9 +97,20 @@ struct RuntimeConfig {
   float row_threshold{0.2f};
   bool snake{false};
   EaseProfile ease{EaseProfile::CubicInOut};
+  const EaseTable *ease_table{nullptr};  // set for EaseProfile::Custom
   bool wobble_enabled{false};
   float wobble_amp_deg{0.0f};
   float wobble_freq_deg{12.0f};
+  // Derive each row's lit_count from its activation time instead of stepping
+  // one sub-step per frame, so duration is independent of frame rate.
+  bool analytic_timing{false};
+
+  // Bumped whenever a knob changes; 0 means "unversioned, derive every frame".
+  uint32_t version{0};
+  // Derived once per version by derive().
+  uint32_t step_ms{0};
+
+  void derive();
 };
 
 struct EffectPlan {
@@ -84,13 +124,151 @@ struct ResumeSnapshot {
   std::vector<float> lit_rows;
 };
 
-struct RowProgress {
-  // Working state per mapped row.
-  int row_len{0};
-  float lit_count{0.0f};
-  float substep_acc{0.0f};
-  bool active{false};
-  bool finished{false};
+// One step of an on-device sequence: run a plan until it finishes, or hold
+// the current output for hold_ms.
+struct SequenceStep {
+  EffectPlan plan{};
+  uint32_t hold_ms{0};  // non-zero makes this a hold step
+};
+
+struct Sequence {
+  std::string name;
+  std::vector<SequenceStep> steps;
+};
+
+// Walks a Sequence from the effect's frame loop, so steps switch plans in
+// place without re-selecting an effect. The first step is always a plan.
+class Sequencer {
+ public:
+  // The caller has already started the first step's plan.
+  void start(const Sequence *sequence, uint32_t now_ms) {
+    sequence_ = sequence;
+    step_ = 0;
+    step_start_ms_ = now_ms;
+  }
+  void stop() { sequence_ = nullptr; }
+  bool running() const { return sequence_ != nullptr; }
+  const Sequence *sequence() const { return sequence_; }
+  size_t step() const { return step_; }
+  bool holding() const { return sequence_ != nullptr && sequence_->steps[step_].hold_ms != 0; }
+  // Restart the running hold from now.
+  void extend_hold(uint32_t now_ms) { step_start_ms_ = now_ms; }
+  // Move past a finished plan or an expired hold; returns the plan to start
+  // next, or nullptr. Stops after the last step.
+  const EffectPlan *advance(bool plan_finished, uint32_t now_ms);
+
+ protected:
+  const Sequence *sequence_{nullptr};
+  size_t step_{0};
+  uint32_t step_start_ms_{0};
+};
+
+// Lit prefix lengths are Q16.16 head steps (LEDs, with one head per row):
+// whole steps in the high half, head progress in the low half.
+constexpr uint32_t kQ16One = 1u << 16;
+
+// Where a row's fill heads start. Every head lights the LEDs ahead of it at
+// once, so a row fills in as many steps as its longest head run (its span).
+enum class HeadMode : uint8_t {
+  Single = 0,    // one head from the row start
+  BothEnds = 1,  // from both ends, meeting in the middle
+  Center = 2,    // from the middle towards both ends
+  Spaced = 3,    // evenly spaced heads, each filling up to the next
+};
+
+// One flag per row, packed 32 to a word so searches skip whole words.
+class RowBits {
+ public:
+  void assign(size_t bits, bool value);
+  void reserve(size_t bits) { words_.reserve((bits + 31) / 32); }
+  bool test(size_t i) const { return (words_[i >> 5] >> (i & 31)) & 1u; }
+  void set(size_t i) { words_[i >> 5] |= 1u << (i & 31); }
+  void reset(size_t i) { words_[i >> 5] &= ~(1u << (i & 31)); }
+  size_t count() const;
+  // Lowest set bit at or after i, or -1.
+  int next(int i) const;
+  // Highest set bit at or before i, or -1.
+  int prev(int i) const;
+  size_t heap_bytes() const { return words_.capacity() * sizeof(uint32_t); }
+
+ private:
+  std::vector<uint32_t> words_;
+  size_t size_{0};
+};
+
+// Geometry and repaint state of the mapped rows, shared by every plan layer.
+struct RowTable {
+  std::vector<uint16_t> len;
+  std::vector<uint16_t> span;      // head steps to fill the row (len with a single head)
+  std::vector<uint16_t> gate;      // lit steps (or cleared steps for OFF) before the next row unlocks
+  std::vector<uint32_t> step_q16;  // time per head step, Q16.16 ms (analytic timing)
+  std::vector<uint32_t> level;     // painted intensity summed over the row, 255 per lit LED
+  RowBits dirty;                   // some layer moved since the row was last painted
+
+  size_t size() const { return len.size(); }
+  bool empty() const { return len.empty(); }
+  void assign(size_t rows);
+  void reserve(size_t rows);
+  void clear() { assign(0); }
+  size_t heap_bytes() const;
+};
+
+// How a layer's intensity combines with the composite of the layers below it.
+enum class LayerBlend : uint8_t { Max = 0, Add = 1, Subtract = 2 };
+
+// The base plan plus up to three plans layered on top of it.
+constexpr size_t kMaxPlanLayers = 4;
+
+// Progress of one plan over the mapped rows as parallel arrays, indexed by row.
+struct PlanLayer {
+  EffectPlan plan{};
+  LayerBlend blend{LayerBlend::Max};
+  std::vector<uint32_t> lit;        // lit prefix, Q16.16 head steps
+  std::vector<uint32_t> start_lit;  // lit at activation (analytic timing)
+  std::vector<uint32_t> start_ms;   // activation time (analytic timing)
+  std::vector<uint16_t> acc_ms;     // time banked towards the next fade sub-step
+  RowBits active;
+  RowBits open;  // not finished yet
+  // Ascending indices of the active rows, so per-frame work scales with them;
+  // unfinished rows are found through `open`.
+  std::vector<uint16_t> active_rows;
+  size_t open_count{0};
+  bool lead_in{false};  // start the first row one fade sub-step in
+
+  bool finished() const { return open_count == 0; }
+  // Resize to `rows` fresh rows (all dark, open, inactive).
+  void assign(size_t rows);
+  void reserve(size_t rows);
+  size_t heap_bytes() const;
+};
+
+const EaseTable &ease_table_for(const RuntimeConfig &cfg);
+
+struct PaintedStyle {
+  // Inputs that change every lit pixel; any difference forces a full repaint.
+  esphome::Color color{esphome::Color::BLACK};
+  bool snake{false};
+  const EaseTable *ease{nullptr};
+  bool wobble_enabled{false};
+  float wobble_amp_deg{0.0f};
+  float wobble_freq_deg{0.0f};
+
+  bool operator==(const PaintedStyle &o) const {
+    return color == o.color && snake == o.snake && ease == o.ease && wobble_enabled == o.wobble_enabled &&
+           wobble_amp_deg == o.wobble_amp_deg && wobble_freq_deg == o.wobble_freq_deg;
+  }
+  bool operator!=(const PaintedStyle &o) const { return !(*this == o); }
+
+  static PaintedStyle from(const RuntimeConfig &cfg, const esphome::Color &color) {
+    PaintedStyle style;
+    style.color = color;
+    style.snake = cfg.snake;
+    style.ease = &ease_table_for(cfg);
+    style.wobble_enabled = cfg.wobble_enabled;
+    style.wobble_amp_deg = cfg.wobble_amp_deg;
+    style.wobble_freq_deg = cfg.wobble_freq_deg;
+    return style;
+  }
 };
 
 struct BaseColorState {
@@ -101,74 +279,439 @@ struct BaseColorState {
   float v{0.0f};
 };
 
+struct WobblePalette {
+  // Base color pre-rotated across [-amp, +amp] degrees of hue. Per-pixel
+  // wobble becomes a table index plus an integer blend, no HSV round-trip.
+  static constexpr int kSteps = 64;
+  esphome::Color entries[kSteps + 1];
+  esphome::Color key_rgb{esphome::Color::BLACK};
+  float key_amp{-1.0f};
+
+  // Rebuild only when the base color or hue amplitude changed.
+  void prepare(const BaseColorState &base_state, float hue_amp);
+  // Color for a Q15 sine sample (-32767..32767).
+  esphome::Color sample(int32_t sin_q15) const;
+};
+
+// LED map in CSR form as emitted into flash by codegen: row r spans
+// [row_offsets[r], row_offsets[r + 1]) of phys (forward) and phys_snake
+// (odd rows pre-reversed for zig-zag).
+struct StaticLedMap {
+  const uint32_t *row_offsets{nullptr};
+  const uint16_t *phys{nullptr};
+  const uint16_t *phys_snake{nullptr};
+  size_t rows{0};
+};
+
+struct LedLayout {
+  // CSR view the render loop walks; points either at the owned vectors below
+  // (compiled from a runtime map) or straight at a StaticLedMap in flash.
+  StaticLedMap view{};
+  std::vector<uint32_t> row_offsets;
+  std::vector<uint16_t> phys;
+  std::vector<uint16_t> phys_snake;
+
+  void compile(const std::vector<std::vector<int>> &map);
+  void assign(const StaticLedMap &map);
+  size_t rows() const { return view.rows; }
+  size_t size() const { return view.rows == 0 ? 0 : view.row_offsets[view.rows]; }
+  uint32_t row_offset(size_t row) const { return view.row_offsets[row]; }
+  int row_len(size_t row) const { return (int) (view.row_offsets[row + 1] - view.row_offsets[row]); }
+  const uint16_t *row(size_t row, bool snake) const {
+    return (snake ? view.phys_snake : view.phys) + view.row_offsets[row];
+  }
+  // Pre-size the owned tables for a runtime map of up to rows x leds.
+  void reserve(size_t rows, size_t leds);
+  // Heap held by the owned tables (zero for a flash map).
+  size_t heap_bytes() const {
+    return row_offsets.capacity() * sizeof(uint32_t) + (phys.capacity() + phys_snake.capacity()) * sizeof(uint16_t);
+  }
+};
+
 struct MapValidationResult {
   bool valid{false};
   std::string message{"map not checked"};
 };
 
+// Off-strip paint target for background rendering. Holds a full frame and
+// remembers which pixels were written, so present() copies only those.
+class PixelBuffer {
+ public:
+  class PixelRef {
+   public:
+    PixelRef(PixelBuffer &owner, int32_t index) : owner_(owner), index_(index) {}
+    PixelRef &operator=(const esphome::Color &color) {
+      owner_.write(index_, color);
+      return *this;
+    }
+    esphome::Color get() const { return owner_.pixels_[index_]; }
+
+   private:
+    PixelBuffer &owner_;
+    int32_t index_;
+  };
+
+  // Match the strip length; reserves the written list so painting never
+  // allocates. Returns true when the size changed and the buffer was cleared.
+  bool resize(size_t size);
+  int32_t size() const { return (int32_t) pixels_.size(); }
+  PixelRef operator[](int32_t index) { return PixelRef(*this, index); }
+  // Pixels written since the last present().
+  size_t pending() const { return written_.size(); }
+  // Copy the pixels written since the last call onto the strip; returns the count.
+  size_t present(esphome::light::AddressableLight &strip);
+  size_t memory_usage() const {
+    return pixels_.capacity() * sizeof(esphome::Color) + marked_.capacity() + written_.capacity() * sizeof(uint16_t);
+  }
+
+ private:
+  void write(int32_t index, const esphome::Color &color) {
+    pixels_[index] = color;
+    if (marked_[index]) return;
+    marked_[index] = 1;
+    written_.push_back((uint16_t) index);
+  }
+
+  std::vector<esphome::Color> pixels_;
+  std::vector<uint8_t> marked_;
+  std::vector<uint16_t> written_;
+};
+
 class FcobProgressTracker {
  public:
   // Attach the LED map (id(map) from YAML).
   void bind_map(const std::vector<std::vector<int>> *map);
+  // Attach a map baked into flash by codegen (led_map: in YAML).
+  void bind_static_map(const StaticLedMap *map);
+  // Between frames, switch to `layout`, compiled from `map` off the render
+  // path (a map replaced at runtime); `layout` gets the old tables back.
+  // Layers are folded as far as that is seamless (see fold_layers()), then
+  // every row of every layer keeps its progress as a fraction of its new
+  // span and its place in the frontier. Rows the old map
+  // lacked start dark, so a fill lights them. The next frame blanks the old
+  // map's LEDs in the same pass that paints the new map.
+  void swap_layout(const std::vector<std::vector<int>> *map, LedLayout &layout);
+  // Size row, frontier, shadow and layout storage once (at setup) so later
+  // binds, effect starts and frames within these bounds never allocate.
+  void reserve(size_t rows, size_t leds);
+  // Fill heads per row (`count` of them for HeadMode::Spaced). Meant for
+  // setup, before reserve(); a later change keeps each row's progress as a
+  // fraction of its new span and repaints.
+  void set_row_heads(HeadMode mode, int count = 1);
+  // Pace every row to fill in row_ms whatever its length, so a lit staircase
+  // takes a fixed time; 0 gives every head step per_led_ms. Rows with a row
+  // time always advance on analytic timing.
+  void set_row_time(uint32_t row_ms);
   // Reset progress; optionally keep the current lit counts for resume.
   void reset(bool clear_resume = true);
 
   // Scan the strip to recover already-lit prefixes (scan-in/out).
   void sync_from_strip(esphome::light::AddressableLight &strip, bool snake);
+  // O(rows) check (O(LEDs) with several heads) that the strip still shows what
+  // the last frame painted, so a following effect can resume from the tracked
+  // progress without a scan.
+  bool output_matches_strip(esphome::light::AddressableLight &strip) const;
   // Load an external snapshot back into working memory.
   void load_snapshot(const ResumeSnapshot &snapshot);
   // Capture current per-row progress.
   ResumeSnapshot snapshot() const;
+  // Same, reusing the capacity of an existing snapshot.
+  void snapshot(ResumeSnapshot &out) const;
 
-  // Start an effect plan; optionally reuse resume data.
+  // Start an effect plan; optionally reuse resume data. Layers fold into the
+  // resumed progress where that leaves the output unchanged; an off wave
+  // still darkening part of the strip, and layers above it, keep running
+  // and turn towards the new plan instead.
   void start_effect(const EffectPlan &plan, bool resume);
+  // Run another plan on top of the running ones, composited per pixel with
+  // `blend`; an OFF plan becomes darkness filling in (always Subtract). A Max
+  // layer picks up the lit prefix showing from the start of each row. A
+  // layer that finishes settles itself and everything below it into the base
+  // plan. False when unbound or all kMaxPlanLayers are in use. A slot's
+  // tables are allocated on its first use and kept.
+  bool add_layer(const EffectPlan &plan, LayerBlend blend);
+  // Plans running, base plan included.
+  size_t layers() const { return layer_count_; }
+  // Render the plan's first frame one fade sub-step in, so a triggered start
+  // shows light on that frame instead of the next one.
+  void lead_in() { lead_in_ = true; }
 
   // Advance the effect by one frame and repaint the strip.
   bool render_frame(esphome::light::AddressableLight &strip,
                     const RuntimeConfig &cfg,
                     const esphome::Color &base_color,
-                    uint32_t now_ms);
+                    uint32_t now_ms) {
+    return render_frame_into(strip, cfg, base_color, now_ms);
+  }
+  // Same frame painted into an off-strip canvas (background rendering).
+  bool render_frame(PixelBuffer &canvas, const RuntimeConfig &cfg, const esphome::Color &base_color, uint32_t now_ms) {
+    return render_frame_into(canvas, cfg, base_color, now_ms);
+  }
+
+  // Drop the shadow buffer so the next frame rewrites every mapped pixel
+  // (e.g. after something outside the tracker touched the strip).
+  void invalidate_output() { repaint_all_ = true; }
 
   bool finished() const { return finished_; }
-  EffectPlan plan() const { return plan_; }
+  // The base plan; layers settle into it as they finish.
+  EffectPlan plan() const { return layers_[0].plan; }
+  // Pixels written to the strip by the last render_frame().
+  size_t leds_written() const { return leds_written_; }
+  // True when the last render_frame() capped dt (the animation fell behind).
+  bool dt_clamped() const { return dt_clamped_; }
+  // Intensity painted over the mapped LEDs as of the last frame, 255 per fully
+  // lit LED. Kept up to date by the pixels each frame writes, so reading it
+  // costs nothing; see PowerLimiter.
+  uint32_t output_level() const { return output_level_; }
+  // Bytes held by the tracker, including its heap-allocated tables.
+  size_t memory_usage() const;
+  // True when a render_frame() with these inputs could not change the strip:
+  // plan finished, nothing pending a repaint and no wobble animating.
+  bool idle(const RuntimeConfig &cfg, const esphome::Color &base_color) const;
 
  private:
   const std::vector<std::vector<int>> *map_{nullptr};
-  EffectPlan plan_{};
-  std::vector<RowProgress> rows_;
+  const StaticLedMap *static_map_{nullptr};
+  LedLayout layout_;
+  RowTable rows_;
+  // layers_[0] is the base plan; layers_[1, layer_count_) composite on top.
+  std::array<PlanLayer, kMaxPlanLayers> layers_;
+  size_t layer_count_{1};
+  std::vector<uint8_t> shadow_;   // last painted intensity per layout slot
+  // LEDs of swapped-out maps still to be blanked, one bit each; sized by
+  // reserve() and swap_layout(), never while rendering.
+  std::vector<uint32_t> retired_;
+  bool retired_pending_{false};
+  // Head step of every layout slot; empty with a single head (the slot index).
+  std::vector<uint16_t> head_steps_;
+  HeadMode heads_{HeadMode::Single};
+  int head_count_{1};
+  bool steps_stale_{true};
+  uint32_t row_ms_{0};
+  BaseColorState base_state_{};   // HSV of the last base color
+  WobblePalette palette_{};
+  PaintedStyle painted_{};
+  bool repaint_all_{true};
+  bool output_valid_{false};  // shadow_ mirrors the strip as of the last frame
+  size_t leds_written_{0};
+  uint32_t output_level_{0};  // sum of rows_.level
+  bool dt_clamped_{false};
   bool finished_{true};
   bool first_frame_{true};
+  bool lead_in_{false};
   uint32_t last_frame_ms_{0};
-
+  uint32_t wobble_phase_{0};  // wrap-safe wobble phase, 2^32 per turn
+  uint32_t gates_version_{0};
+  bool gates_stale_{true};
+  uint32_t max_step_ms_{0};  // slowest row's fade sub-step
+  uint32_t lead_ms_{0};      // one fade sub-step of the slowest row, rounded up
+  // Timing knobs the active rows were anchored with (analytic timing).
+  uint32_t anchor_per_led_ms_{0};
+  int anchor_fade_steps_{0};
+  bool anchor_analytic_{false};
+
+  bool bound() const { return map_ != nullptr || static_map_ != nullptr; }
+  // Queue every LED of the current layout for blanking before it is replaced.
+  void retire_layout();
+  // Shared tail of bind_map()/bind_static_map() after a layout change.
+  void layout_changed();
   // Ensure our row vector matches the current map size.
   void ensure_row_cache();
-  // Refresh cached row lengths after any map updates.
+  // Refresh cached row lengths and spans after any map or head updates.
   void refresh_row_lengths();
-  // Make sure at least one unfinished row is active.
-  void ensure_active_row();
+  // Drop all rows and layers (unbound map).
+  void clear_rows();
+  // Row `ridx` of all layers as one lit prefix (see flatten_layers()).
+  uint32_t composite_lit(size_t ridx) const;
+  // Lit prefix showing from the start of row `ridx`: none behind an off wave
+  // that has darkened its first steps.
+  uint32_t shown_prefix(size_t ridx) const;
+  // Fold the layers into the base plan's progress and drop them.
+  void flatten_layers();
+  // Fold only what the base plan can show unchanged (see fold_layers()).
+  void fold_layers();
+  // Point a kept layer at a new base plan's goal (see start_effect()).
+  void redirect_layer(PlanLayer &layer, const EffectPlan &plan);
+  // Settle the highest finished layer and everything below it into the base.
+  void collapse_finished_layers();
+  // Make sure at least one unfinished row of the layer is active.
+  void ensure_active_row(PlanLayer &layer, uint32_t now_ms);
   // Find the next unfinished row from either end.
-  int first_available_row(bool from_top) const;
+  int first_available_row(const PlanLayer &layer, bool from_top) const;
   // Find the neighbor row relative to the active one.
-  int neighbor_row(int current, bool from_top) const;
-  // Flag a row as active and reset its timers.
-  void activate_row(int idx);
+  int neighbor_row(const PlanLayer &layer, int current, bool from_top) const;
+  // Finish rows from idx on that the layers below already light in full.
+  int skip_covered_rows(PlanLayer &layer, int idx, bool from_top);
+  // Flag a row as active and reset its timers; at_ms anchors analytic timing.
+  void activate_row(PlanLayer &layer, int idx, uint32_t at_ms);
+  // Mark a row finished and deactivate it.
+  void finish_row(PlanLayer &layer, size_t ridx);
+  // Rebuild the active frontier and open count from the row flags.
+  void rebuild_schedule(PlanLayer &layer);
+  // Advance one active row by a frame and unlock its neighbour.
+  template<FlowMode Flow>
+  void step_row(PlanLayer &layer, size_t ridx, const RuntimeConfig &cfg, uint32_t dt_ms, uint32_t now_ms);
+  // Advance every active row of a layer by a frame.
+  template<FlowMode Flow> void step_rows(PlanLayer &layer, const RuntimeConfig &cfg, uint32_t dt_ms, uint32_t now_ms);
+  // Restart analytic timing of active rows from their current progress.
+  void reanchor_active_rows(PlanLayer &layer, uint32_t now_ms);
+  // Analytic timing: set lit_count from elapsed time since activation.
+  void advance_row_analytic(PlanLayer &layer, size_t ridx, const RuntimeConfig &cfg, uint32_t now_ms, bool fill);
+  // Analytic timing: when the row first satisfied its unlock gate.
+  uint32_t analytic_unlock_time(const PlanLayer &layer, size_t ridx, const RuntimeConfig &cfg, bool fill) const;
   // Aggregate per-row finished flags.
   void update_finished_flag();
+  // Recompute per-row unlock gates and step timing when the config or map changed.
+  void refresh_unlock_gates(const RuntimeConfig &cfg);
+
+  // Black out the LEDs of swapped-out maps (see swap_layout()).
+  template<typename Strip> void blank_retired(Strip &strip);
+  // Body of both render_frame() overloads; Strip is the paint target.
+  template<typename Strip>
+  bool render_frame_into(Strip &strip, const RuntimeConfig &cfg, const esphome::Color &base_color, uint32_t now_ms);
+  // Advance and repaint every row for one frame. Flow direction, wobble and
+  // multi-head rows are template parameters so each combination compiles to
+  // its own branch-free loop; render_frame() picks one through kRenderKernels.
+  template<typename Strip, FlowMode Flow, bool Wobble, bool Stepped>
+  void render_rows(Strip &strip,
+                   const RuntimeConfig &cfg,
+                   uint32_t phase,
+                   uint32_t dt_ms,
+                   uint32_t now_ms,
+                   bool repaint_all);
+  // Same with layers running: step every layer, then paint each moved row
+  // once with the layers composited per pixel (kLayerKernels).
+  template<typename Strip, bool Wobble, bool Stepped>
+  void render_layers(Strip &strip,
+                     const RuntimeConfig &cfg,
+                     uint32_t phase,
+                     uint32_t dt_ms,
+                     uint32_t now_ms,
+                     bool repaint_all);
+  // Write the pixels of one row whose output differs from the shadow buffer.
+  // Stepped rows light each slot by its head step instead of its index.
+  template<typename Strip, bool Wobble, bool Layered, bool Stepped>
+  void paint_row(Strip &strip,
+                 const RuntimeConfig &cfg,
+                 size_t ridx,
+                 uint32_t phase,
+                 bool repaint_all);
+
+  // Write one color to row slots [from, to) and stamp their shadow in one go;
+  // slots off the strip are skipped, shadow included, as in the per-pixel
+  // path. Returns the number of pixels written.
+  template<typename Strip>
+  size_t fill_span(Strip &strip,
+                   int strip_size,
+                   const uint16_t *row_phys,
+                   uint8_t *row_shadow,
+                   int from,
+                   int to,
+                   uint8_t q,
+                   const esphome::Color &color);
+
+  template<typename Strip>
+  using RenderKernel = void (FcobProgressTracker::*)(Strip &, const RuntimeConfig &, uint32_t, uint32_t, uint32_t,
+                                                     bool);
+  // Indexed [flow][wobble_live][stepped].
+  template<typename Strip> static const RenderKernel<Strip> kRenderKernels[2][2][2];
+  // Indexed [wobble_live][stepped].
+  template<typename Strip> static const RenderKernel<Strip> kLayerKernels[2][2];
+};
+
+// Renders frames on a background worker: a FreeRTOS task pinned to the core
+// the light loop is not on (ESP32), or a std::thread on host builds. The loop
+// and the worker pass the tracker and canvas back and forth through one atomic
+// state word: while idle() the caller owns both, submit() lends them to the
+// worker until the frame is painted.
+class AsyncRenderer {
+ public:
+  AsyncRenderer() = default;
+  AsyncRenderer(const AsyncRenderer &) = delete;
+  AsyncRenderer &operator=(const AsyncRenderer &) = delete;
+  ~AsyncRenderer() { stop(); }
+
+  // Spawn the worker; false when the platform has no second core to use.
+  bool start(FcobProgressTracker *tracker);
+  // Let the queued frame finish and end the worker.
+  void stop();
+  bool running() const { return running_; }
+  // True when no frame is queued or rendering.
+  bool idle() const { return state_.load(std::memory_order_acquire) == kIdle; }
+  // Spin until the worker hands the tracker back.
+  void wait_idle() const;
+  PixelBuffer &canvas() { return canvas_; }
+  // Queue the next frame for the worker; only valid while idle().
+  void submit(const RuntimeConfig &cfg, const esphome::Color &base_color, uint32_t now_ms);
+
+ private:
+  static constexpr uint8_t kIdle = 0;
+  static constexpr uint8_t kQueued = 1;
+
+  void run();
+  void wake();
+  void wait_for_work();
+#if defined(USE_ESP32)
+  static void task_entry(void *arg);
+#endif
 
-  void handle_fill_frame(esphome::light::AddressableLight &strip,
-                         const RuntimeConfig &cfg,
-                         const BaseColorState &base_state,
-                         float t_sec,
-                         uint32_t dt_ms);
-  void handle_off_frame(esphome::light::AddressableLight &strip,
-                        const RuntimeConfig &cfg,
-                        const BaseColorState &base_state,
-                        float t_sec,
-                        uint32_t dt_ms);
+  FcobProgressTracker *tracker_{nullptr};
+  PixelBuffer canvas_;
+  // Inputs of the queued frame, written only while idle().
+  RuntimeConfig cfg_{};
+  esphome::Color color_{esphome::Color::BLACK};
+  uint32_t now_ms_{0};
+  std::atomic<uint8_t> state_{kIdle};
+  std::atomic<bool> quit_{false};
+  bool running_{false};
+#if defined(USE_ESP32)
+  TaskHandle_t task_{nullptr};
+  std::atomic<bool> exited_{false};
+#elif defined(USE_HOST)
+  // Only parks the worker between frames; the handoff itself is state_.
+  std::thread thread_;
+  std::mutex wake_mutex_;
+  std::condition_variable wake_cv_;
+#endif
 };
 
+// Keeps the estimated LED current within a budget by scaling the base color.
+// The estimate prices the tracker's output_level() at the color's channels
+// and the light's brightness; it leaves out gamma, so it errs high. The level
+// is a frame old when the color is picked, so the scale is set for the level
+// the next frame reaches at the recent growth. A new scale repaints the
+// lit pixels once, so it drops with some headroom while a fill grows and only
+// comes back up once the plan has settled or the output is dark.
+class PowerLimiter {
+ public:
+  // budget_ma 0 only estimates. channel_ma is one color channel at full.
+  void configure(float budget_ma, float channel_ma) {
+    budget_ma_ = budget_ma;
+    channel_ma_ = channel_ma;
+  }
+  // Color to paint this frame with, from the level of the last frame.
+  esphome::Color limit(const esphome::Color &color, uint32_t level, float brightness, bool settled);
+  // Current drawn by the last limited frame, mA.
+  float estimate_ma() const { return estimate_ma_; }
+  // 255 while within budget.
+  uint8_t scale() const { return scale_; }
+  // The effect stopped, so its LEDs draw nothing; the scale is kept for the
+  // next effect, which picks up from the same output.
+  void clear_estimate() { estimate_ma_ = 0.0f; }
+
+ private:
+  float budget_ma_{0.0f};
+  float channel_ma_{20.0f};
+  uint32_t last_level_{0};
+  uint32_t growth_{0};  // level gained per frame, peak-held
+  uint8_t scale_{255};
+  float estimate_ma_{0.0f};
+};
+
+uint32_t next_config_version();
 uint32_t compute_step_ms(uint32_t per_led_ms, int fade_steps);
 float apply_ease(EaseProfile ease, float t);
+const EaseTable &builtin_ease_table(EaseProfile ease);
 bool should_unlock(int len, int progress, float thr, bool off_mode);
 bool should_unlock_on(int len, int progress, float thr);
 bool should_unlock_off(int len, int progress, float thr);
@@ -180,28 +723,45 @@ int scan_resume_row_prefix(esphome::light::AddressableLight &strip,
                            const std::vector<std::vector<int>> &map,
                            int row,
                            bool snake);
+int scan_resume_row_prefix(esphome::light::AddressableLight &strip, const uint16_t *phys, int len);
+int scan_resume_row_steps(esphome::light::AddressableLight &strip,
+                          const uint16_t *phys,
+                          const uint16_t *steps,
+                          int len,
+                          int span);
+uint16_t head_span(int len, HeadMode mode, int count);
+uint16_t head_step(int i, int len, HeadMode mode, int count);
 bool is_led_lit_soft(esphome::light::AddressableLight &strip, int phys_led);
 esphome::Color scale_color(const esphome::Color &c, float factor);
+esphome::Color scale_color_u8(const esphome::Color &c, uint8_t scale);
 bool row_reverse_forward_fill(int row_index, bool snake_on);
-bool advance_one_substep(float &acc_ms, uint32_t step_ms, uint32_t dt_ms);
+bool advance_one_substep(uint16_t &acc_ms, uint32_t step_ms, uint32_t dt_ms);
+uint32_t q16_to_substeps(uint32_t lit, int fade_steps);
+uint32_t substeps_to_q16(uint32_t steps, int fade_steps);
+uint32_t q16_from_float(float leds);
 float clamp01(float v);
 FcobProgressTracker &global_tracker();
 void rgb2hsv(uint8_t r, uint8_t g, uint8_t b, float &h, float &s, float &v);
 esphome::Color hsv2rgb(float h, float s, float v);
+int32_t sin_bam_q15(uint32_t phase);
+uint32_t wobble_phase_step(float freq_deg, uint32_t dt_ms);
 float sin_deg_fast(float degrees);
 float smoothstep(float edge0, float edge1, float x);
+bool wobble_is_live(const BaseColorState &base_state, const RuntimeConfig &cfg);
+float wobble_hue_amp(const BaseColorState &base_state, const RuntimeConfig &cfg);
 esphome::Color wobble_sample(const BaseColorState &base_state,
                              const RuntimeConfig &cfg,
                              int row_index,
                              int phys_led,
-                             float t_sec);
+                             uint32_t phase);
 esphome::Color color_with_wobble(const BaseColorState &base_state,
                                  const RuntimeConfig &cfg,
                                  int row_index,
                                  int phys_led,
                                  float intensity,
-                                 float t_sec);
+                                 uint32_t phase);
 MapValidationResult validate_led_map(const std::vector<std::vector<int>> &map, int total_leds);
+MapValidationResult parse_led_map(const std::string &text, std::vector<std::vector<int>> &out);
 
 }  // namespace ledhelpers
 
@@ -210,321 +770,1309 @@ namespace ledhelpers {
 
 namespace {
 constexpr uint8_t kMinOnU8 = 6;                 // lit detection floor
-constexpr float kEpsilon = 0.0001f;             // tiny tolerance for comparisons
+constexpr uint16_t kInvalidPhys = 0xFFFF;       // compiled slot that never hits the strip
 constexpr float kWobbleVMin = 0.15f;            // wobble ramps in near this V
 constexpr float kWobbleVMax = 0.60f;            // wobble peaks by this V
-constexpr float kRowPhaseMul = 9.5f;            // row-specific wobble phase spread
-constexpr float kLedPhaseMul = 0.5f;            // per-pixel wobble phase spread
-constexpr float kPi = 3.14159265358979323846f;  // pi constant
+constexpr uint32_t kRowPhaseMul = 113339415u;   // row-specific wobble phase spread (9.5 deg)
+constexpr uint32_t kLedPhaseMul = 5965232u;     // per-pixel wobble phase spread (0.5 deg)
+constexpr float kBamPerDeg = 11930464.711f;     // 2^32 phase units per 360 degrees
+constexpr float kBamPerDegMs = 11930.464711f;   // phase units per (deg/s * ms)
+
+// sin() over one turn in Q15, 256 steps plus a wrap guard for interpolation.
+constexpr int16_t kSinQ15[257] = {
+    0, 804, 1608, 2410, 3212, 4011, 4808, 5602, 6393, 7179, 7962, 8739, 9512, 10278, 11039, 11793,
+    12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530, 18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+    23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790, 27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+    30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971, 32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757,
+    32767, 32757, 32728, 32678, 32609, 32521, 32412, 32285, 32137, 31971, 31785, 31580, 31356, 31113, 30852, 30571,
+    30273, 29956, 29621, 29268, 28898, 28510, 28105, 27683, 27245, 26790, 26319, 25832, 25329, 24811, 24279, 23731,
+    23170, 22594, 22005, 21403, 20787, 20159, 19519, 18868, 18204, 17530, 16846, 16151, 15446, 14732, 14010, 13279,
+    12539, 11793, 11039, 10278, 9512, 8739, 7962, 7179, 6393, 5602, 4808, 4011, 3212, 2410, 1608, 804,
+    0, -804, -1608, -2410, -3212, -4011, -4808, -5602, -6393, -7179, -7962, -8739, -9512, -10278, -11039, -11793,
+    -12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530, -18204, -18868, -19519, -20159, -20787, -21403, -22005, -22594,
+    -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790, -27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956,
+    -30273, -30571, -30852, -31113, -31356, -31580, -31785, -31971, -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+    -32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285, -32137, -31971, -31785, -31580, -31356, -31113, -30852, -30571,
+    -30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683, -27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731,
+    -23170, -22594, -22005, -21403, -20787, -20159, -19519, -18868, -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+    -12539, -11793, -11039, -10278, -9512, -8739, -7962, -7179, -6393, -5602, -4808, -4011, -3212, -2410, -1608, -804,
+    0,
+};
 }  // namespace
 
+// Flatten a nested map into the CSR layout used by the render loop.
+inline void LedLayout::compile(const std::vector<std::vector<int>> &map) {
+  size_t total = 0;
+  for (const auto &row : map) total += row.size();
+  row_offsets.assign(map.size() + 1, 0u);
+  phys.resize(total);
+  phys_snake.resize(total);
+
+  uint32_t off = 0;
+  for (size_t r = 0; r < map.size(); ++r) {
+    const auto &row = map[r];
+    const size_t len = row.size();
+    row_offsets[r] = off;
+    for (size_t i = 0; i < len; ++i) {
+      const int idx = row[i];
+      const uint16_t slot = (idx < 0 || idx >= kInvalidPhys) ? kInvalidPhys : (uint16_t) idx;
+      phys[off + i] = slot;
+      phys_snake[off + (row_reverse_forward_fill((int) r, true) ? len - 1 - i : i)] = slot;
+    }
+    off += (uint32_t) len;
+  }
+  row_offsets[map.size()] = off;
+  view = {row_offsets.data(), phys.data(), phys_snake.data(), map.size()};
+}
+
+inline void LedLayout::reserve(size_t rows, size_t leds) {
+  row_offsets.reserve(rows + 1);
+  phys.reserve(leds);
+  phys_snake.reserve(leds);
+  // Growing may have moved a compiled table.
+  if (!row_offsets.empty()) view = {row_offsets.data(), phys.data(), phys_snake.data(), view.rows};
+}
+
+inline void RowBits::assign(size_t bits, bool value) {
+  size_ = bits;
+  words_.assign((bits + 31) / 32, value ? ~0u : 0u);
+  // Keep the bits past the end clear so searches never report them.
+  if (value && (bits & 31) != 0) words_.back() = (1u << (bits & 31)) - 1u;
+}
+
+inline size_t RowBits::count() const {
+  size_t n = 0;
+  for (uint32_t w : words_) n += (size_t) __builtin_popcount(w);
+  return n;
+}
+
+inline int RowBits::next(int i) const {
+  if (i < 0) i = 0;
+  if ((size_t) i >= size_) return -1;
+  size_t w = (size_t) i >> 5;
+  uint32_t bits = words_[w] & (~0u << (i & 31));
+  while (bits == 0) {
+    if (++w >= words_.size()) return -1;
+    bits = words_[w];
+  }
+  return (int) (w * 32 + __builtin_ctz(bits));
+}
+
+inline int RowBits::prev(int i) const {
+  if (i < 0 || size_ == 0) return -1;
+  if ((size_t) i >= size_) i = (int) size_ - 1;
+  size_t w = (size_t) i >> 5;
+  uint32_t bits = words_[w] & (~0u >> (31 - (i & 31)));
+  while (bits == 0) {
+    if (w-- == 0) return -1;
+    bits = words_[w];
+  }
+  return (int) (w * 32 + 31 - __builtin_clz(bits));
+}
+
+inline void RowTable::assign(size_t rows) {
+  len.assign(rows, 0);
+  span.assign(rows, 0);
+  gate.assign(rows, 0);
+  step_q16.assign(rows, 0);
+  level.assign(rows, 0);
+  dirty.assign(rows, true);
+}
+
+inline void RowTable::reserve(size_t rows) {
+  len.reserve(rows);
+  span.reserve(rows);
+  gate.reserve(rows);
+  step_q16.reserve(rows);
+  level.reserve(rows);
+  dirty.reserve(rows);
+}
+
+inline size_t RowTable::heap_bytes() const {
+  return (len.capacity() + span.capacity() + gate.capacity()) * sizeof(uint16_t) +
+         (step_q16.capacity() + level.capacity()) * sizeof(uint32_t) + dirty.heap_bytes();
+}
+
+inline void PlanLayer::assign(size_t rows) {
+  lit.assign(rows, 0);
+  start_lit.assign(rows, 0);
+  start_ms.assign(rows, 0);
+  acc_ms.assign(rows, 0);
+  active.assign(rows, false);
+  open.assign(rows, true);
+  active_rows.clear();
+  open_count = rows;
+  lead_in = false;
+}
+
+inline void PlanLayer::reserve(size_t rows) {
+  lit.reserve(rows);
+  start_lit.reserve(rows);
+  start_ms.reserve(rows);
+  acc_ms.reserve(rows);
+  active.reserve(rows);
+  open.reserve(rows);
+  active_rows.reserve(rows);
+}
+
+inline size_t PlanLayer::heap_bytes() const {
+  return (lit.capacity() + start_lit.capacity() + start_ms.capacity()) * sizeof(uint32_t) +
+         (acc_ms.capacity() + active_rows.capacity()) * sizeof(uint16_t) + active.heap_bytes() + open.heap_bytes();
+}
+
+// Use a codegen table in place; nothing is copied into RAM.
+inline void LedLayout::assign(const StaticLedMap &map) {
+  row_offsets = {};
+  phys = {};
+  phys_snake = {};
+  view = map;
+}
+
+// Bind and compile the map. The component rebinds on every frame, so only a
+// different map object recompiles; edits made in place are picked up by
+// swap_layout() (stairs_effects.set_map without a map reloads them).
 inline void FcobProgressTracker::bind_map(const std::vector<std::vector<int>> *map) {
+  if (map == map_ && static_map_ == nullptr) return;
+  map_ = map;
+  static_map_ = nullptr;
+  if (map_) layout_.compile(*map_);
+  else layout_ = LedLayout{};
+  layout_changed();
+}
+
+// Flash maps never change shape, so only a different table triggers a rebind.
+inline void FcobProgressTracker::bind_static_map(const StaticLedMap *map) {
+  if (map == static_map_ && map_ == nullptr) return;
+  static_map_ = map;
+  map_ = nullptr;
+  if (map != nullptr) layout_.assign(*map);
+  else layout_ = LedLayout{};
+  layout_changed();
+}
+
+inline void FcobProgressTracker::retire_layout() {
+  for (size_t i = 0; i < layout_.size(); ++i) {
+    const uint16_t phys = layout_.view.phys[i];
+    if (phys == kInvalidPhys || ((size_t) phys >> 5) >= retired_.size()) continue;
+    retired_[phys >> 5] |= 1u << (phys & 31);
+    retired_pending_ = true;
+  }
+}
+
+inline void FcobProgressTracker::swap_layout(const std::vector<std::vector<int>> *map, LedLayout &layout) {
+  // reserve() covers led_count; a map past it grows the mask here, in the
+  // set_map() call that already allocates, never on a frame.
+  size_t words = retired_.size();
+  for (const LedLayout *l : {&layout_, &layout}) {
+    for (size_t i = 0; i < l->size(); ++i) {
+      const uint16_t phys = l->view.phys[i];
+      if (phys != kInvalidPhys) words = std::max(words, ((size_t) phys >> 5) + 1);
+    }
+  }
+  if (words > retired_.size()) retired_.resize(words, 0u);
+  retire_layout();
+  fold_layers();
+  std::swap(layout_, layout);
   map_ = map;
+  static_map_ = nullptr;
+
+  const size_t old_rows = rows_.size();
+  const size_t rows = layout_.rows();
+  for (size_t k = 0; k < layer_count_; ++k) {
+    PlanLayer &layer = layers_[k];
+    // Rows both maps have keep their progress; scale it before the old spans go.
+    for (size_t i = 0; i < std::min(old_rows, rows); ++i) {
+      const uint32_t from = rows_.span[i];
+      const uint32_t to = head_span(std::min(layout_.row_len(i), 0xFFFF), heads_, head_count_);
+      layer.lit[i] = from == 0 ? 0 : (uint32_t) ((uint64_t) layer.lit[i] * to / from);
+    }
+    layer.lit.resize(rows, 0u);
+    layer.start_lit.resize(rows, 0u);
+    layer.start_ms.resize(rows, 0u);
+    layer.acc_ms.resize(rows, 0u);
+    layer.active.assign(rows, false);
+    layer.open.assign(rows, false);
+    for (uint16_t idx : layer.active_rows) {
+      if (idx < rows) layer.active.set(idx);
+    }
+  }
+  rows_.assign(rows);
+  layout_changed();
+  for (size_t k = 0; k < layer_count_; ++k) {
+    PlanLayer &layer = layers_[k];
+    const bool fill = layer.plan.flow == FlowMode::Fill;
+    for (size_t i = 0; i < rows; ++i) {
+      if (fill ? layer.lit[i] < (uint32_t) rows_.span[i] << 16 : layer.lit[i] > 0) layer.open.set(i);
+    }
+    rebuild_schedule(layer);
+    reanchor_active_rows(layer, last_frame_ms_);
+  }
+  update_finished_flag();
+}
+
+inline void FcobProgressTracker::reserve(size_t rows, size_t leds) {
+  rows_.reserve(rows);
+  layers_[0].reserve(rows);
+  shadow_.reserve(leds);
+  if (retired_.size() < (leds + 31) / 32) retired_.resize((leds + 31) / 32, 0u);
+  if (heads_ != HeadMode::Single) head_steps_.reserve(leds);
+  if (static_map_ == nullptr) layout_.reserve(rows, leds);
+}
+
+inline void FcobProgressTracker::set_row_heads(HeadMode mode, int count) {
+  count = std::max(1, count);
+  if (mode == heads_ && count == head_count_) return;
+  heads_ = mode;
+  head_count_ = count;
+  steps_stale_ = true;
+  gates_stale_ = true;
+  if (!bound()) return;
+  head_steps_.assign(heads_ == HeadMode::Single ? 0 : layout_.size(), 0u);
+  for (size_t i = 0; i < rows_.size(); ++i) {
+    const uint32_t from = rows_.span[i];
+    const uint32_t to = head_span(rows_.len[i], heads_, head_count_);
+    if (from == 0 || from == to) continue;
+    for (size_t k = 0; k < layer_count_; ++k) layers_[k].lit[i] = (uint32_t) ((uint64_t) layers_[k].lit[i] * to / from);
+  }
+  refresh_row_lengths();
+  for (size_t k = 0; k < layer_count_; ++k) reanchor_active_rows(layers_[k], last_frame_ms_);
+  repaint_all_ = true;
+  output_valid_ = false;
+}
+
+inline void FcobProgressTracker::set_row_time(uint32_t row_ms) {
+  if (row_ms == row_ms_) return;
+  row_ms_ = row_ms;
+  gates_stale_ = true;
+  for (size_t k = 0; k < layer_count_; ++k) reanchor_active_rows(layers_[k], last_frame_ms_);
+}
+
+inline void FcobProgressTracker::layout_changed() {
+  shadow_.assign(layout_.size(), 0u);
+  head_steps_.assign(heads_ == HeadMode::Single ? 0 : layout_.size(), 0u);
+  steps_stale_ = true;
+  repaint_all_ = true;
+  output_valid_ = false;
+  gates_stale_ = true;
   ensure_row_cache();
+  // The shadow starts dark again, and so does the level it sums.
+  std::fill(rows_.level.begin(), rows_.level.end(), 0u);
+  output_level_ = 0;
   refresh_row_lengths();
 }
 
 // Clear cached progress and optionally zero resume data.
 inline void FcobProgressTracker::reset(bool clear_resume) {
   finished_ = true;
+  repaint_all_ = true;
+  output_valid_ = false;
   first_frame_ = true;
   last_frame_ms_ = 0;
-  if (!map_) {
-    rows_.clear();
+  if (!bound()) {
+    clear_rows();
     return;
   }
   ensure_row_cache();
   refresh_row_lengths();
-  for (auto &row : rows_) {
-    row.active = false;
-    row.substep_acc = 0.0f;
-    if (clear_resume || plan_.flow == FlowMode::Fill) row.lit_count = 0.0f;
-    if (clear_resume && plan_.flow == FlowMode::Off) row.lit_count = (float) row.row_len;
-    row.finished = row.row_len <= 0;
+  flatten_layers();
+  PlanLayer &base = layers_[0];
+  for (size_t i = 0; i < rows_.size(); ++i) {
+    base.active.reset(i);
+    base.acc_ms[i] = 0;
+    if (clear_resume || base.plan.flow == FlowMode::Fill) base.lit[i] = 0;
+    if (clear_resume && base.plan.flow == FlowMode::Off) base.lit[i] = (uint32_t) rows_.span[i] << 16;
+    base.open.set(i);
   }
+  rebuild_schedule(base);
 }
 
 // Recover per-row lit prefix counts from the strip, used for scan-in/out.
 inline void FcobProgressTracker::sync_from_strip(esphome::light::AddressableLight &strip,
                                                  bool snake) {
-  if (!map_) return;
+  if (!bound()) return;
   ensure_row_cache();
   refresh_row_lengths();
+  repaint_all_ = true;
+  output_valid_ = false;
+  // What the strip shows replaces every layer.
+  layer_count_ = 1;
+  PlanLayer &base = layers_[0];
   for (size_t idx = 0; idx < rows_.size(); ++idx) {
-    auto &row = rows_[idx];
-    row.lit_count = (float) scan_resume_row_prefix(strip, *map_, (int) idx, snake);
-    row.active = false;
-    row.finished = row.row_len <= 0 || row.lit_count >= row.row_len - kEpsilon;
-    row.substep_acc = 0.0f;
+    const int len = rows_.len[idx];
+    const int span = rows_.span[idx];
+    const uint16_t *row_phys = layout_.row(idx, snake);
+    const int lit = head_steps_.empty()
+                        ? scan_resume_row_prefix(strip, row_phys, len)
+                        : scan_resume_row_steps(strip, row_phys, head_steps_.data() + layout_.row_offset(idx), len, span);
+    base.lit[idx] = (uint32_t) lit << 16;
+    base.active.reset(idx);
+    if (lit < span) base.open.set(idx);
+    else base.open.reset(idx);
+    base.acc_ms[idx] = 0;
+  }
+  rebuild_schedule(base);
+}
+
+// Probe the last fully lit and first dark pixel around each layer's head
+// against the shadow buffer; anything else touching the strip is caught here.
+inline bool FcobProgressTracker::output_matches_strip(esphome::light::AddressableLight &strip) const {
+  if (!bound() || !output_valid_ || rows_.size() != layout_.rows()) return false;
+  const int strip_size = strip.size();
+  auto probe = [&](const uint16_t *row_phys, const uint8_t *row_shadow, int i) {
+    if (row_phys[i] >= strip_size) return true;
+    const auto c = strip[row_phys[i]].get();
+    const bool lit = (c.r | c.g | c.b) != 0;
+    return lit == (row_shadow[i] != 0);
+  };
+  for (size_t idx = 0; idx < rows_.size(); ++idx) {
+    const int len = rows_.len[idx];
+    const uint16_t *row_phys = layout_.row(idx, painted_.snake);
+    const uint8_t *row_shadow = shadow_.data() + layout_.row_offset(idx);
+    const uint16_t *row_steps = head_steps_.empty() ? nullptr : head_steps_.data() + layout_.row_offset(idx);
+    for (size_t k = 0; k < layer_count_; ++k) {
+      const int full = std::min((int) (layers_[k].lit[idx] >> 16), (int) rows_.span[idx]);
+      if (row_steps == nullptr) {
+        for (int i : {full - 1, full + 1}) {
+          if (i >= 0 && i < len && !probe(row_phys, row_shadow, i)) return false;
+        }
+        continue;
+      }
+      // Every head has its last lit and first dark LED one step either side.
+      for (int i = 0; i < len; ++i) {
+        const int d = (int) row_steps[i] - full;
+        if ((d == -1 || d == 1) && !probe(row_phys, row_shadow, i)) return false;
+      }
+    }
   }
+  return true;
 }
 
 // Restore progress from a previously taken snapshot.
 inline void FcobProgressTracker::load_snapshot(const ResumeSnapshot &snapshot) {
-  if (!map_) return;
+  if (!bound()) return;
   ensure_row_cache();
   refresh_row_lengths();
+  repaint_all_ = true;
+  output_valid_ = false;
+  layer_count_ = 1;
+  PlanLayer &base = layers_[0];
   const size_t lim = std::min(rows_.size(), snapshot.lit_rows.size());
   for (size_t i = 0; i < lim; ++i) {
-    auto &row = rows_[i];
-    row.lit_count =
-        esphome::clamp(snapshot.lit_rows[i], 0.0f, (float) std::max(0, row.row_len));
-    row.active = false;
-    row.finished = row.row_len <= 0 || row.lit_count >= row.row_len - kEpsilon;
-    row.substep_acc = 0.0f;
+    const uint32_t full = (uint32_t) rows_.span[i] << 16;
+    base.lit[i] = std::min(q16_from_float(snapshot.lit_rows[i]), full);
+    base.active.reset(i);
+    if (base.lit[i] < full) base.open.set(i);
+    else base.open.reset(i);
+    base.acc_ms[i] = 0;
   }
+  rebuild_schedule(base);
 }
 
 // Capture current per-row lit counts.
 inline ResumeSnapshot FcobProgressTracker::snapshot() const {
   ResumeSnapshot snap;
-  snap.lit_rows.reserve(rows_.size());
-  for (const auto &row : rows_) snap.lit_rows.push_back(row.lit_count);
+  snapshot(snap);
   return snap;
 }
 
+inline void FcobProgressTracker::snapshot(ResumeSnapshot &out) const {
+  out.lit_rows.resize(rows_.size());
+  for (size_t i = 0; i < rows_.size(); ++i) out.lit_rows[i] = (float) composite_lit(i) / (float) kQ16One;
+}
+
 // Initialize an effect plan and optionally reuse resume state.
 inline void FcobProgressTracker::start_effect(const EffectPlan &plan, bool resume) {
-  plan_ = plan;
+  PlanLayer &base = layers_[0];
+  base.plan = plan;
   finished_ = false;
   first_frame_ = true;
+  repaint_all_ = true;
   last_frame_ms_ = 0;
-  if (!map_) {
-    rows_.clear();
+  if (!bound()) {
+    clear_rows();
     finished_ = true;
     return;
   }
   ensure_row_cache();
   refresh_row_lengths();
-  for (auto &row : rows_) {
-    row.active = false;
-    row.substep_acc = 0.0f;
-    if (!resume) {
-      row.lit_count = (plan_.flow == FlowMode::Fill) ? 0.0f : (float) row.row_len;
-    } else {
-      row.lit_count = esphome::clamp(row.lit_count, 0.0f, (float) row.row_len);
-    }
-    row.finished = row.row_len <= 0 ||
-                   (plan_.flow == FlowMode::Fill ? (row.lit_count >= row.row_len - kEpsilon)
-                                                 : (row.lit_count <= kEpsilon));
+  if (resume) fold_layers();
+  else layer_count_ = 1;
+  const bool fill = plan.flow == FlowMode::Fill;
+  for (size_t i = 0; i < rows_.size(); ++i) {
+    const uint32_t full = (uint32_t) rows_.span[i] << 16;
+    base.active.reset(i);
+    base.acc_ms[i] = 0;
+    if (!resume) base.lit[i] = fill ? 0 : full;
+    // Resumed counts were clamped to the row by refresh_row_lengths().
+    if (fill ? base.lit[i] < full : base.lit[i] > 0) base.open.set(i);
+    else base.open.reset(i);
   }
-  ensure_active_row();
+  rebuild_schedule(base);
+  ensure_active_row(base, last_frame_ms_);
+  for (size_t k = 1; k < layer_count_; ++k) redirect_layer(layers_[k], plan);
   update_finished_flag();
 }
 
+inline bool FcobProgressTracker::add_layer(const EffectPlan &plan, LayerBlend blend) {
+  if (!bound() || rows_.empty() || layer_count_ >= kMaxPlanLayers) return false;
+  PlanLayer &layer = layers_[layer_count_];
+  layer.reserve(rows_.size());
+  layer.assign(rows_.size());
+  // New layers fill; an OFF layer fills in darkness instead of light.
+  layer.plan = {FlowMode::Fill, plan.order};
+  layer.blend = plan.flow == FlowMode::Off ? LayerBlend::Subtract : blend;
+  for (size_t i = 0; i < rows_.size(); ++i) {
+    if (layer.blend != LayerBlend::Max) continue;
+    layer.lit[i] = shown_prefix(i);
+    if (layer.lit[i] != 0) rows_.dirty.set(i);
+    if (layer.lit[i] >= (uint32_t) rows_.span[i] << 16) layer.open.reset(i);
+  }
+  rebuild_schedule(layer);
+  layer.lead_in = true;
+  layer_count_++;
+  finished_ = false;
+  return true;
+}
+
+template<typename Strip>
+inline void FcobProgressTracker::blank_retired(Strip &strip) {
+  const int strip_size = strip.size();
+  for (size_t w = 0; w < retired_.size(); ++w) {
+    for (uint32_t bits = retired_[w]; bits != 0; bits &= bits - 1) {
+      const int phys = (int) (w * 32 + __builtin_ctz(bits));
+      if (phys >= strip_size) continue;
+      strip[phys] = esphome::Color::BLACK;
+      leds_written_++;
+    }
+    retired_[w] = 0;
+  }
+  retired_pending_ = false;
+}
+
 // Step the effect once and repaint the entire strip.
-inline bool FcobProgressTracker::render_frame(esphome::light::AddressableLight &strip,
-                                              const RuntimeConfig &cfg,
-                                              const esphome::Color &base_color,
-                                              uint32_t now_ms) {
-  if (!map_ || rows_.empty()) return false;
+template<typename Strip>
+inline bool FcobProgressTracker::render_frame_into(Strip &strip,
+                                                   const RuntimeConfig &cfg_in,
+                                                   const esphome::Color &base_color,
+                                                   uint32_t now_ms) {
+  if (!bound() || rows_.empty()) return false;
   ensure_row_cache();
-  refresh_row_lengths();
-  ensure_active_row();
+
+  // Versioned configs arrive pre-derived; ad-hoc ones are derived here.
+  RuntimeConfig local;
+  if (cfg_in.version == 0) {
+    local = cfg_in;
+    local.derive();
+  }
+  const RuntimeConfig &cfg = cfg_in.version == 0 ? local : cfg_in;
+  refresh_unlock_gates(cfg);
 
   if (first_frame_) {
     first_frame_ = false;
-    last_frame_ms_ = now_ms;
+    const uint32_t lead = lead_in_ ? lead_ms_ : 0;
+    lead_in_ = false;
+    last_frame_ms_ = now_ms - lead;
+    reanchor_active_rows(layers_[0], now_ms - lead);
+  }
+  if (cfg.per_led_ms != anchor_per_led_ms_ || cfg.fade_steps != anchor_fade_steps_ ||
+      cfg.analytic_timing != anchor_analytic_) {
+    for (size_t k = 0; k < layer_count_; ++k) reanchor_active_rows(layers_[k], now_ms);
+    anchor_per_led_ms_ = cfg.per_led_ms;
+    anchor_fade_steps_ = cfg.fade_steps;
+    anchor_analytic_ = cfg.analytic_timing;
+  }
+  ensure_active_row(layers_[0], now_ms);
+  for (size_t k = 1; k < layer_count_; ++k) {
+    PlanLayer &layer = layers_[k];
+    ensure_active_row(layer, now_ms);
+    if (!layer.lead_in) continue;
+    // Same lead as a triggered first frame, banked on the new frontier only.
+    layer.lead_in = false;
+    const uint32_t lead = lead_ms_;
+    for (uint16_t idx : layer.active_rows) {
+      layer.start_ms[idx] = now_ms - lead;
+      layer.acc_ms[idx] = (uint16_t) std::min<uint32_t>(lead, 0xFFFF);
+    }
   }
   uint32_t dt_ms = now_ms - last_frame_ms_;
   last_frame_ms_ = now_ms;
+  // Wobble runs on wall time (unclamped dt) in integer phase so it never loses
+  // resolution however long the controller has been up.
+  wobble_phase_ += wobble_phase_step(cfg.wobble_freq_deg, dt_ms);
 
-  const uint32_t step_ms = compute_step_ms(cfg.per_led_ms, cfg.fade_steps);
+  const uint32_t step_ms = max_step_ms_;
+  dt_clamped_ = false;
   if (step_ms > 0) {
     const uint32_t cap = step_ms * 2u;
-    if (dt_ms > cap) dt_ms = cap;
+    if (dt_ms > cap) {
+      dt_ms = cap;
+      dt_clamped_ = true;
+    }
+  }
+
+  if (base_color != base_state_.rgb) {
+    base_state_.rgb = base_color;
+    rgb2hsv(base_color.r, base_color.g, base_color.b, base_state_.h, base_state_.s, base_state_.v);
   }
+  const BaseColorState &base_state = base_state_;
+
+  // Style changes touch every lit pixel; otherwise only moved rows (plus lit
+  // pixels while wobble animates) get repainted.
+  const PaintedStyle style = PaintedStyle::from(cfg, base_color);
+  const bool repaint_all = repaint_all_ || style != painted_;
+  const bool wobble_live = wobble_is_live(base_state, cfg);
+  if (wobble_live) palette_.prepare(base_state, wobble_hue_amp(base_state, cfg));
+  leds_written_ = 0;
+  // The new map is repainted in full below, so LEDs both maps share end up
+  // with their new state in this same frame.
+  if (retired_pending_) blank_retired(strip);
+
+  const int stepped = head_steps_.empty() ? 0 : 1;
+  const RenderKernel<Strip> kernel =
+      layer_count_ > 1
+          ? kLayerKernels<Strip>[wobble_live ? 1 : 0][stepped]
+          : kRenderKernels<Strip>[layers_[0].plan.flow == FlowMode::Fill ? 0 : 1][wobble_live ? 1 : 0][stepped];
+  (this->*kernel)(strip, cfg, wobble_phase_, dt_ms, now_ms, repaint_all);
+  painted_ = style;
+  repaint_all_ = false;
+  output_valid_ = true;
+  if (layer_count_ > 1) collapse_finished_layers();
+  update_finished_flag();
+  return true;
+}
+
+inline size_t FcobProgressTracker::memory_usage() const {
+  size_t bytes = sizeof(*this) + rows_.heap_bytes() + shadow_.capacity() +
+                 head_steps_.capacity() * sizeof(uint16_t) + retired_.capacity() * sizeof(uint32_t) +
+                 layout_.heap_bytes();
+  for (const auto &layer : layers_) bytes += layer.heap_bytes();
+  return bytes;
+}
 
+// Idle when a frame would neither advance a row nor change any pixel.
+inline bool FcobProgressTracker::idle(const RuntimeConfig &cfg, const esphome::Color &base_color) const {
+  if (!finished_ || repaint_all_) return false;
+  if (PaintedStyle::from(cfg, base_color) != painted_) return false;
+  if (!cfg.wobble_enabled) return true;
   BaseColorState base_state;
-  base_state.rgb = base_color;
   rgb2hsv(base_color.r, base_color.g, base_color.b, base_state.h, base_state.s, base_state.v);
+  return !wobble_is_live(base_state, cfg);
+}
 
-  const float t_sec = now_ms / 1000.0f;
-
-  if (plan_.flow == FlowMode::Fill) {
-    handle_fill_frame(strip, cfg, base_state, t_sec, dt_ms);
-  } else {
-    handle_off_frame(strip, cfg, base_state, t_sec, dt_ms);
+// Per-row ceil(threshold * span) gates and step timing, recomputed only on a
+// new config version. Head steps take per_led_ms, or with a row time set,
+// row_ms / span: every row then fills in exactly row_ms, since step_row()
+// times such rows analytically (one sub-step per frame at whole-ms steps
+// would stretch a long row many times over).
+inline void FcobProgressTracker::refresh_unlock_gates(const RuntimeConfig &cfg) {
+  if (!gates_stale_ && cfg.version != 0 && cfg.version == gates_version_) return;
+  const float thr = clamp01(cfg.row_threshold);
+  const uint32_t fade_steps = (uint32_t) std::max(1, cfg.fade_steps);
+  const uint32_t per_led_q16 = (uint32_t) std::min<uint64_t>((uint64_t) std::max<uint32_t>(1, cfg.per_led_ms) << 16,
+                                                             UINT32_MAX);
+  // One fade sub-step, rounded up so the analytic path also lands on it.
+  max_step_ms_ = row_ms_ == 0 ? cfg.step_ms : 0;
+  lead_ms_ = row_ms_ == 0 ? std::max<uint32_t>(cfg.step_ms, (cfg.per_led_ms + fade_steps - 1) / fade_steps) : 0;
+  for (size_t i = 0; i < rows_.size(); ++i) {
+    const uint32_t span = rows_.span[i];
+    rows_.gate[i] = (uint16_t) std::ceil(thr * (float) span);
+    if (row_ms_ == 0 || span == 0) {
+      rows_.step_q16[i] = per_led_q16;
+      continue;
+    }
+    const uint64_t sub_q16 = (uint64_t) fade_steps << 16;
+    const uint32_t step_q16 = (uint32_t) std::max<uint64_t>(1, std::min<uint64_t>(((uint64_t) row_ms_ << 16) / span,
+                                                                                   UINT32_MAX));
+    // Whole-ms sub-step, rounded up: bounds dt for the stall counter and sizes
+    // the lead-in.
+    const uint32_t row_step = (uint32_t) std::min<uint64_t>((step_q16 + sub_q16 - 1) / sub_q16, 0xFFFF);
+    rows_.step_q16[i] = step_q16;
+    max_step_ms_ = std::max(max_step_ms_, row_step);
+    lead_ms_ = std::max(lead_ms_, row_step);
   }
-  update_finished_flag();
-  return true;
+  gates_version_ = cfg.version;
+  gates_stale_ = false;
 }
 
 // Ensure rows_ vector matches the bound map.
 inline void FcobProgressTracker::ensure_row_cache() {
-  if (!map_) {
-    rows_.clear();
+  if (!bound()) {
+    clear_rows();
     return;
   }
-  if (rows_.size() != map_->size()) rows_.assign(map_->size(), RowProgress{});
+  if (rows_.size() != layout_.rows()) {
+    rows_.assign(layout_.rows());
+    layer_count_ = 1;
+    layers_[0].assign(layout_.rows());
+    rebuild_schedule(layers_[0]);
+  }
 }
 
-// Sync cached row lengths and clamp lit counts.
+// Sync cached row lengths and spans (and the head step table after a layout
+// or head change), and clamp lit counts.
 inline void FcobProgressTracker::refresh_row_lengths() {
-  if (!map_) return;
+  if (!bound()) return;
   for (size_t i = 0; i < rows_.size(); ++i) {
-    auto &row = rows_[i];
-    row.row_len = row_len(*map_, (int) i);
-    if (row.row_len < 0) row.row_len = 0;
-    row.lit_count = esphome::clamp(row.lit_count, 0.0f, (float) row.row_len);
+    const int len = std::min(layout_.row_len(i), 0xFFFF);
+    rows_.len[i] = (uint16_t) len;
+    rows_.span[i] = head_span(len, heads_, head_count_);
+    if (steps_stale_ && !head_steps_.empty()) {
+      uint16_t *steps = head_steps_.data() + layout_.row_offset(i);
+      for (int j = 0; j < len; ++j) steps[j] = head_step(j, len, heads_, head_count_);
+    }
+    for (size_t k = 0; k < layer_count_; ++k)
+      layers_[k].lit[i] = std::min(layers_[k].lit[i], (uint32_t) rows_.span[i] << 16);
   }
+  steps_stale_ = false;
 }
 
-// Turn on the first unfinished row if none are active.
-inline void FcobProgressTracker::ensure_active_row() {
-  if (rows_.empty()) return;
-  for (const auto &row : rows_) {
-    if (row.active && !row.finished) return;
-  }
-  const bool from_top = plan_.order == RowOrder::TopToBottom;
-  const int idx = first_available_row(from_top);
-  if (idx >= 0) rows_[idx].active = true;
-}
-
-// Find first unfinished row scanning from either side.
-inline int FcobProgressTracker::first_available_row(bool from_top) const {
-  if (rows_.empty()) return -1;
-  if (from_top) {
-    for (int i = (int) rows_.size() - 1; i >= 0; --i)
-      if (!rows_[i].finished) return i;
-  } else {
-    for (int i = 0; i < (int) rows_.size(); ++i)
-      if (!rows_[i].finished) return i;
+inline void FcobProgressTracker::clear_rows() {
+  rows_.clear();
+  output_level_ = 0;
+  layer_count_ = 1;
+  layers_[0].assign(0);
+}
+
+// Lit band [lo, hi) of the layers so far; a light-adding layer that leaves a
+// gap before the band keeps just its own prefix, the part that matters here.
+inline uint32_t FcobProgressTracker::shown_prefix(size_t ridx) const {
+  uint32_t lo = 0;
+  uint32_t hi = layers_[0].lit[ridx];
+  for (size_t k = 1; k < layer_count_; ++k) {
+    const uint32_t top = layers_[k].lit[ridx];
+    if (layers_[k].blend == LayerBlend::Subtract) {
+      lo = std::max(lo, top);
+      if (lo >= hi) lo = hi = 0;
+    } else if (top >= lo) {
+      hi = std::max(hi, top);
+      lo = 0;
+    } else if (top > 0) {
+      hi = top;
+      lo = 0;
+    }
   }
-  return -1;
+  return lo == 0 ? hi : 0;
 }
 
-// Find next unfinished neighbor from the current row.
-inline int FcobProgressTracker::neighbor_row(int current, bool from_top) const {
-  if (rows_.empty()) return -1;
-  int idx = current;
-  while (true) {
-    idx += from_top ? -1 : 1;
-    if (idx < 0 || idx >= (int) rows_.size()) return -1;
-    if (!rows_[idx].finished) return idx;
+// Max and Add keep the longer prefix (exact for whole LEDs); Subtract keeps
+// as many lit LEDs as remain, moved to the front of the row.
+inline uint32_t FcobProgressTracker::composite_lit(size_t ridx) const {
+  uint32_t lit = layers_[0].lit[ridx];
+  for (size_t k = 1; k < layer_count_; ++k) {
+    const uint32_t top = layers_[k].lit[ridx];
+    lit = layers_[k].blend == LayerBlend::Subtract ? (lit > top ? lit - top : 0) : std::max(lit, top);
+  }
+  return lit;
+}
+
+// The base plan resumes from the flattened prefixes, as it would from a
+// strip read-back; callers rebuild its schedule.
+inline void FcobProgressTracker::flatten_layers() {
+  if (layer_count_ == 1) return;
+  for (size_t i = 0; i < rows_.size(); ++i) layers_[0].lit[i] = composite_lit(i);
+  layer_count_ = 1;
+}
+
+// Light-adding layers below the first Subtract layer that darkens anything
+// fold into the base exactly, and layers at zero drop out. The rest stay:
+// a lit band behind an off wave is no prefix, and flattening it would move
+// the band to the front of its row in one frame.
+inline void FcobProgressTracker::fold_layers() {
+  if (layer_count_ == 1) return;
+  PlanLayer &base = layers_[0];
+  size_t kept = 1;
+  for (size_t k = 1; k < layer_count_; ++k) {
+    PlanLayer &layer = layers_[k];
+    const bool empty = std::all_of(layer.lit.begin(), layer.lit.begin() + rows_.size(), [](uint32_t lit) {
+      return lit == 0;
+    });
+    if (empty) continue;
+    if (kept == 1 && layer.blend != LayerBlend::Subtract) {
+      for (size_t i = 0; i < rows_.size(); ++i) base.lit[i] = std::max(base.lit[i], layer.lit[i]);
+      continue;
+    }
+    if (k != kept) std::swap(layers_[kept], layer);
+    kept++;
+  }
+  layer_count_ = kept;
+}
+
+// A kept layer turns towards the new plan's goal: a fill grows the layers
+// adding light and shrinks the Subtract ones, an off plan the other way
+// round. The output moves on from what it shows and, once every layer has
+// got there, settles as the plan would on its own.
+inline void FcobProgressTracker::redirect_layer(PlanLayer &layer, const EffectPlan &plan) {
+  const bool grow = (plan.flow == FlowMode::Fill) == (layer.blend != LayerBlend::Subtract);
+  layer.plan = {grow ? FlowMode::Fill : FlowMode::Off, plan.order};
+  for (size_t i = 0; i < rows_.size(); ++i) {
+    const uint32_t full = (uint32_t) rows_.span[i] << 16;
+    layer.active.reset(i);
+    layer.acc_ms[i] = 0;
+    if (grow ? layer.lit[i] < full : layer.lit[i] > 0) layer.open.set(i);
+    else layer.open.reset(i);
+  }
+  rebuild_schedule(layer);
+  layer.lead_in = false;
+}
+
+// A layer that shrank to nothing (see redirect_layer()) no longer shows and
+// just drops out. Any other finished layer has filled every row, so the
+// composite up to it is uniform: all lit, or all dark under a Subtract
+// layer. That becomes a finished base plan and the layers above keep running
+// on top of it; the output does not change, so nothing needs a repaint.
+inline void FcobProgressTracker::collapse_finished_layers() {
+  size_t kept = 1;
+  for (size_t j = 1; j < layer_count_; ++j) {
+    if (layers_[j].finished() && layers_[j].plan.flow == FlowMode::Off) continue;
+    if (j != kept) std::swap(layers_[kept], layers_[j]);
+    kept++;
+  }
+  layer_count_ = kept;
+  size_t k = layer_count_;
+  while (--k > 0 && !layers_[k].finished()) {
+  }
+  if (k == 0) return;
+  const bool lit = layers_[k].blend != LayerBlend::Subtract;
+  PlanLayer &base = layers_[0];
+  base.plan = {lit ? FlowMode::Fill : FlowMode::Off, layers_[k].plan.order};
+  for (size_t i = 0; i < rows_.size(); ++i) base.lit[i] = lit ? (uint32_t) rows_.span[i] << 16 : 0;
+  base.open.assign(rows_.size(), false);
+  base.active.assign(rows_.size(), false);
+  rebuild_schedule(base);
+  // Swaps keep every slot's tables for reuse.
+  for (size_t j = k + 1; j < layer_count_; ++j) std::swap(layers_[j - k], layers_[j]);
+  layer_count_ -= k;
+}
+
+// Turn on the first unfinished row if none are active.
+inline void FcobProgressTracker::ensure_active_row(PlanLayer &layer, uint32_t now_ms) {
+  if (rows_.empty() || !layer.active_rows.empty()) return;
+  const bool from_top = layer.plan.order == RowOrder::TopToBottom;
+  int idx = first_available_row(layer, from_top);
+  if (layer_count_ > 1) idx = skip_covered_rows(layer, idx, from_top);
+  if (idx >= 0) activate_row(layer, idx, now_ms);
+}
+
+// First unfinished row from either side.
+inline int FcobProgressTracker::first_available_row(const PlanLayer &layer, bool from_top) const {
+  return from_top ? layer.open.prev((int) rows_.size() - 1) : layer.open.next(0);
+}
+
+// Closest unfinished row past the current one (finished rows are skipped).
+inline int FcobProgressTracker::neighbor_row(const PlanLayer &layer, int current, bool from_top) const {
+  if (current < 0 || current >= (int) rows_.size()) return -1;
+  return from_top ? layer.open.prev(current - 1) : layer.open.next(current + 1);
+}
+
+// A layer adding light has nothing to do in rows that the layers below
+// already light in full, e.g. where a fill from the top meets one from the
+// bottom. Only trusted while nothing below can darken again.
+inline int FcobProgressTracker::skip_covered_rows(PlanLayer &layer, int idx, bool from_top) {
+  const size_t k = (size_t) (&layer - layers_.data());
+  if (k == 0 || layer.blend == LayerBlend::Subtract || layers_[0].plan.flow != FlowMode::Fill) return idx;
+  for (size_t j = 1; j < k; ++j) {
+    if (layers_[j].blend == LayerBlend::Subtract || layers_[j].plan.flow != FlowMode::Fill) return idx;
   }
+  while (idx >= 0) {
+    const uint32_t full = (uint32_t) rows_.span[idx] << 16;
+    size_t j = 0;
+    while (j < k && layers_[j].lit[idx] < full) ++j;
+    if (j == k) break;
+    finish_row(layer, idx);
+    idx = neighbor_row(layer, idx, from_top);
+  }
+  return idx;
 }
 
-// Arm a row for animation.
-inline void FcobProgressTracker::activate_row(int idx) {
+// Arm a row for animation and add it to the active frontier.
+inline void FcobProgressTracker::activate_row(PlanLayer &layer, int idx, uint32_t at_ms) {
   if (idx < 0 || idx >= (int) rows_.size()) return;
-  auto &row = rows_[idx];
-  if (row.finished) return;
-  row.active = true;
-  row.substep_acc = 0.0f;
+  if (!layer.open.test(idx)) return;
+  if (!layer.active.test(idx)) {
+    layer.active_rows.insert(std::lower_bound(layer.active_rows.begin(), layer.active_rows.end(), (uint16_t) idx),
+                             (uint16_t) idx);
+    layer.active.set(idx);
+  }
+  layer.acc_ms[idx] = 0;
+  layer.start_ms[idx] = at_ms;
+  layer.start_lit[idx] = layer.lit[idx];
 }
 
-// Recompute the aggregate finished_ flag.
-inline void FcobProgressTracker::update_finished_flag() {
-  finished_ = true;
-  for (const auto &row : rows_) {
-    if (!row.finished) {
-      finished_ = false;
-      break;
+// The frontier drops finished rows after the current pass (see step_rows()).
+inline void FcobProgressTracker::finish_row(PlanLayer &layer, size_t ridx) {
+  layer.active.reset(ridx);
+  if (!layer.open.test(ridx)) return;
+  layer.open.reset(ridx);
+  layer.open_count--;
+}
+
+inline void FcobProgressTracker::rebuild_schedule(PlanLayer &layer) {
+  layer.active_rows.clear();
+  for (size_t i = 0; i < rows_.size(); ++i) {
+    if (rows_.len[i] == 0) layer.open.reset(i);
+    if (!layer.open.test(i)) {
+      layer.active.reset(i);
+    } else if (layer.active.test(i)) {
+      layer.active_rows.push_back((uint16_t) i);
     }
   }
+  layer.open_count = layer.open.count();
 }
 
-// Progress ON animation and repaint rows with wobble applied.
-inline void FcobProgressTracker::handle_fill_frame(esphome::light::AddressableLight &strip,
-                                                   const RuntimeConfig &cfg,
-                                                   const BaseColorState &base_state,
-                                                   float t_sec,
-                                                   uint32_t dt_ms) {
-  if (!map_) return;
-  const uint32_t step_ms = compute_step_ms(cfg.per_led_ms, cfg.fade_steps);
-  const float substep = 1.0f / (float) std::max(1, cfg.fade_steps);
-  const bool from_top = plan_.order == RowOrder::TopToBottom;
+// Re-anchor active rows at their current progress (first frame, timing knob change).
+inline void FcobProgressTracker::reanchor_active_rows(PlanLayer &layer, uint32_t now_ms) {
+  for (uint16_t idx : layer.active_rows) {
+    layer.start_ms[idx] = now_ms;
+    layer.start_lit[idx] = layer.lit[idx];
+  }
+}
 
-  for (size_t ridx = 0; ridx < rows_.size(); ++ridx) {
-    auto &row = rows_[ridx];
-    if (row.row_len <= 0) {
-      row.finished = true;
-      continue;
+// lit = start_lit +/- whole sub-steps elapsed since activation, so slow frames
+// are absorbed without drift.
+inline void FcobProgressTracker::advance_row_analytic(PlanLayer &layer, size_t ridx, const RuntimeConfig &cfg,
+                                                      uint32_t now_ms, bool fill) {
+  const uint32_t elapsed = now_ms - layer.start_ms[ridx];
+  const uint64_t steps = ((uint64_t) elapsed << 16) * (uint32_t) std::max(1, cfg.fade_steps) / rows_.step_q16[ridx];
+  const uint32_t start = q16_to_substeps(layer.start_lit[ridx], cfg.fade_steps);
+  const uint64_t last = (uint64_t) rows_.span[ridx] * (uint32_t) std::max(1, cfg.fade_steps);
+  uint32_t lit;
+  if (fill && start + steps >= last) {
+    lit = (uint32_t) rows_.span[ridx] << 16;
+    finish_row(layer, ridx);
+  } else if (!fill && steps >= start) {
+    lit = 0;
+    finish_row(layer, ridx);
+  } else {
+    lit = substeps_to_q16(fill ? start + (uint32_t) steps : start - (uint32_t) steps, cfg.fade_steps);
+  }
+  if (lit != layer.lit[ridx]) {
+    layer.lit[ridx] = lit;
+    rows_.dirty.set(ridx);
+  }
+}
+
+// Exact time the row's lit prefix first met its unlock gate; the next row is
+// anchored there so chained rows do not accumulate frame-time drift.
+inline uint32_t FcobProgressTracker::analytic_unlock_time(const PlanLayer &layer, size_t ridx,
+                                                          const RuntimeConfig &cfg, bool fill) const {
+  const int64_t steps_per_led = std::max(1, cfg.fade_steps);
+  const int64_t start = q16_to_substeps(layer.start_lit[ridx], cfg.fade_steps);
+  // Sub-steps the head has to travel from start_lit.
+  int64_t steps;
+  if (fill) {
+    steps = (int64_t) rows_.gate[ridx] * steps_per_led - start;
+    if (steps <= 0) return layer.start_ms[ridx];
+  } else {
+    steps = start - (int64_t) (rows_.span[ridx] - rows_.gate[ridx] + 1) * steps_per_led;
+    if (steps < 0) return layer.start_ms[ridx];
+    steps += 1;
+  }
+  const uint64_t sub_q16 = (uint64_t) steps_per_led << 16;
+  return layer.start_ms[ridx] + (uint32_t) (((uint64_t) steps * rows_.step_q16[ridx] + sub_q16 - 1) / sub_q16);
+}
+
+// Recompute the aggregate finished_ flag; finished layers have already
+// collapsed into the base, so any layer left is still running.
+inline void FcobProgressTracker::update_finished_flag() {
+  finished_ = layer_count_ == 1 && layers_[0].finished();
+}
+
+// Progress one active row (FILL grows its lit prefix, OFF shrinks it) and
+// unlock its neighbour once the row passes its gate.
+template<FlowMode Flow>
+inline void FcobProgressTracker::step_row(PlanLayer &layer, size_t ridx, const RuntimeConfig &cfg, uint32_t dt_ms,
+                                          uint32_t now_ms) {
+  constexpr bool kFill = Flow == FlowMode::Fill;
+  if (!layer.active.test(ridx) || !layer.open.test(ridx)) return;
+  const int len = rows_.len[ridx];
+  if (len == 0) {
+    finish_row(layer, ridx);
+    return;
+  }
+  const int span = rows_.span[ridx];
+  // A row time is a wall-clock promise, so those rows never step per frame.
+  const bool analytic = cfg.analytic_timing || row_ms_ != 0;
+  if (analytic) {
+    advance_row_analytic(layer, ridx, cfg, now_ms, kFill);
+  } else if (cfg.step_ms > 0 && advance_one_substep(layer.acc_ms[ridx], cfg.step_ms, dt_ms)) {
+    // One sub-step on the 1/fade_steps grid: integer math, whole steps exact.
+    const uint32_t at = q16_to_substeps(layer.lit[ridx], cfg.fade_steps);
+    const uint32_t last = (uint32_t) span * (uint32_t) std::max(1, cfg.fade_steps);
+    const bool done = kFill ? at + 1 >= last : at <= 1;
+    layer.lit[ridx] = done ? (kFill ? (uint32_t) span << 16 : 0)
+                           : substeps_to_q16(kFill ? at + 1 : at - 1, cfg.fade_steps);
+    rows_.dirty.set(ridx);
+    if (done) finish_row(layer, ridx);
+  }
+
+  // A row that finished within this frame still hands over here, at its own
+  // unlock time, rather than through ensure_active_row() a frame later.
+  const int lit_int = (int) (layer.lit[ridx] >> 16);
+  const int progress = kFill ? lit_int : span - lit_int;
+  if (progress >= rows_.gate[ridx]) {
+    const bool from_top = layer.plan.order == RowOrder::TopToBottom;
+    int next = neighbor_row(layer, (int) ridx, from_top);
+    if (layer_count_ > 1) next = skip_covered_rows(layer, next, from_top);
+    const uint32_t at = analytic ? analytic_unlock_time(layer, ridx, cfg, kFill) : now_ms;
+    if (next >= 0 && !layer.active.test(next)) activate_row(layer, next, at);
+  }
+}
+
+// Step a layer's frontier in index order; a row unlocked above the current
+// one is still stepped this frame.
+template<FlowMode Flow>
+inline void FcobProgressTracker::step_rows(PlanLayer &layer, const RuntimeConfig &cfg, uint32_t dt_ms,
+                                           uint32_t now_ms) {
+  auto &active = layer.active_rows;
+  for (size_t k = 0; k < active.size(); ++k) {
+    const uint16_t ridx = active[k];
+    step_row<Flow>(layer, ridx, cfg, dt_ms, now_ms);
+    // A neighbour inserted below shifts this row one slot up.
+    if (active[k] != ridx) ++k;
+  }
+  active.erase(std::remove_if(active.begin(), active.end(), [&layer](uint16_t idx) { return !layer.active.test(idx); }),
+               active.end());
+}
+
+// Advance the active rows for one frame and repaint. Active rows are visited in
+// index order; a row unlocked above the current one is still stepped this frame.
+template<typename Strip, FlowMode Flow, bool Wobble, bool Stepped>
+inline void FcobProgressTracker::render_rows(Strip &strip,
+                                             const RuntimeConfig &cfg,
+                                             uint32_t phase,
+                                             uint32_t dt_ms,
+                                             uint32_t now_ms,
+                                             bool repaint_all) {
+  if (!bound()) return;
+  // Full repaints and wobble rewrite every lit pixel, so they paint all rows
+  // after stepping; otherwise only stepped rows can be dirty.
+  const bool paint_all = repaint_all || Wobble;
+  PlanLayer &base = layers_[0];
+  auto &active = base.active_rows;
+  for (size_t k = 0; k < active.size(); ++k) {
+    const uint16_t ridx = active[k];
+    step_row<Flow>(base, ridx, cfg, dt_ms, now_ms);
+    // A neighbour inserted below shifts this row one slot up.
+    if (active[k] != ridx) ++k;
+    if (!paint_all) paint_row<Strip, Wobble, false, Stepped>(strip, cfg, ridx, phase, repaint_all);
+  }
+  if (paint_all) {
+    for (size_t ridx = 0; ridx < rows_.size(); ++ridx)
+      paint_row<Strip, Wobble, false, Stepped>(strip, cfg, ridx, phase, repaint_all);
+  }
+  active.erase(std::remove_if(active.begin(), active.end(), [&base](uint16_t idx) { return !base.active.test(idx); }),
+               active.end());
+}
+
+// Layers step independently (each has its own flow), but every row is still
+// painted at most once per frame however many layers moved it.
+template<typename Strip, bool Wobble, bool Stepped>
+inline void FcobProgressTracker::render_layers(Strip &strip,
+                                               const RuntimeConfig &cfg,
+                                               uint32_t phase,
+                                               uint32_t dt_ms,
+                                               uint32_t now_ms,
+                                               bool repaint_all) {
+  if (!bound()) return;
+  for (size_t k = 0; k < layer_count_; ++k) {
+    PlanLayer &layer = layers_[k];
+    if (layer.plan.flow == FlowMode::Fill) step_rows<FlowMode::Fill>(layer, cfg, dt_ms, now_ms);
+    else step_rows<FlowMode::Off>(layer, cfg, dt_ms, now_ms);
+  }
+  if (repaint_all || Wobble) {
+    for (size_t ridx = 0; ridx < rows_.size(); ++ridx)
+      paint_row<Strip, Wobble, true, Stepped>(strip, cfg, ridx, phase, repaint_all);
+  } else {
+    for (int ridx = rows_.dirty.next(0); ridx >= 0; ridx = rows_.dirty.next(ridx + 1))
+      paint_row<Strip, Wobble, true, Stepped>(strip, cfg, ridx, phase, repaint_all);
+  }
+}
+
+template<typename Strip>
+inline const FcobProgressTracker::RenderKernel<Strip> FcobProgressTracker::kRenderKernels[2][2][2] = {
+    {{&FcobProgressTracker::render_rows<Strip, FlowMode::Fill, false, false>,
+      &FcobProgressTracker::render_rows<Strip, FlowMode::Fill, false, true>},
+     {&FcobProgressTracker::render_rows<Strip, FlowMode::Fill, true, false>,
+      &FcobProgressTracker::render_rows<Strip, FlowMode::Fill, true, true>}},
+    {{&FcobProgressTracker::render_rows<Strip, FlowMode::Off, false, false>,
+      &FcobProgressTracker::render_rows<Strip, FlowMode::Off, false, true>},
+     {&FcobProgressTracker::render_rows<Strip, FlowMode::Off, true, false>,
+      &FcobProgressTracker::render_rows<Strip, FlowMode::Off, true, true>}},
+};
+
+template<typename Strip>
+inline const FcobProgressTracker::RenderKernel<Strip> FcobProgressTracker::kLayerKernels[2][2] = {
+    {&FcobProgressTracker::render_layers<Strip, false, false>,
+     &FcobProgressTracker::render_layers<Strip, false, true>},
+    {&FcobProgressTracker::render_layers<Strip, true, false>,
+     &FcobProgressTracker::render_layers<Strip, true, true>},
+};
+
+// Repaint one row, skipping settled rows and pixels whose intensity is unchanged.
+// Layered rows blend each layer's lit prefix into the base one pixel at a time.
+template<typename Strip, bool Wobble, bool Layered, bool Stepped>
+inline void FcobProgressTracker::paint_row(Strip &strip,
+                                           const RuntimeConfig &cfg,
+                                           size_t ridx,
+                                           uint32_t phase,
+                                           bool repaint_all) {
+  const uint32_t lit = layers_[0].lit[ridx];
+  if (!repaint_all && !rows_.dirty.test(ridx)) {
+    if (!Wobble) return;
+    // Wobble repaints lit rows only; with layers, whatever any of them lights.
+    bool any = lit != 0;
+    for (size_t k = 1; Layered && !any && k < layer_count_; ++k) any = layers_[k].lit[ridx] != 0;
+    if (!any) return;
+  }
+  rows_.dirty.reset(ridx);
+
+  const int len = rows_.len[ridx];
+  const int span = rows_.span[ridx];
+  const int full = std::min((int) (lit >> 16), span);
+  // Head progress (low half) rounded to the 256-step ease table.
+  const uint8_t head = full < span ? ease_table_for(cfg).lut[((lit & 0xFFFFu) * 255u + 0x8000u) >> 16] : 0;
+  int layer_full[kMaxPlanLayers];
+  uint8_t layer_head[kMaxPlanLayers];
+  for (size_t k = 1; Layered && k < layer_count_; ++k) {
+    const uint32_t top = layers_[k].lit[ridx];
+    layer_full[k] = std::min((int) (top >> 16), span);
+    layer_head[k] = layer_full[k] < span ? ease_table_for(cfg).lut[((top & 0xFFFFu) * 255u + 0x8000u) >> 16] : 0;
+  }
+  const uint16_t *row_steps = Stepped ? head_steps_.data() + layout_.row_offset(ridx) : nullptr;
+  const uint16_t *row_phys = layout_.row(ridx, cfg.snake);
+  uint8_t *row_shadow = shadow_.data() + layout_.row_offset(ridx);
+  const uint32_t row_phase = (uint32_t) ridx * kRowPhaseMul;
+  const int strip_size = strip.size();
+  const esphome::Color base = base_state_.rgb;
+  if (!Layered && !Stepped && !Wobble && repaint_all) {
+    // Solid full repaint: lit prefix and dark tail are uniform spans.
+    const size_t lit_on_strip = fill_span(strip, strip_size, row_phys, row_shadow, 0, full, 255, base);
+    if (full < len && row_phys[full] < strip_size) {
+      row_shadow[full] = head;
+      strip[row_phys[full]] = head == 0 ? esphome::Color::BLACK : (head == 255 ? base : scale_color_u8(base, head));
+      leds_written_++;
     }
-    if (row.active && !row.finished && step_ms > 0) {
-      if (advance_one_substep(row.substep_acc, step_ms, dt_ms)) {
-        row.lit_count += substep;
-        if (row.lit_count >= row.row_len - kEpsilon) {
-          row.lit_count = (float) row.row_len;
-          row.finished = true;
-          row.active = false;
+    fill_span(strip, strip_size, row_phys, row_shadow, full + 1, len, 0, esphome::Color::BLACK);
+    // A head off the strip keeps its old shadow.
+    const uint32_t level = (uint32_t) lit_on_strip * 255u + (full < len ? row_shadow[full] : 0u);
+    output_level_ += level - rows_.level[ridx];
+    rows_.level[ridx] = level;
+    return;
+  }
+  int32_t level_delta = 0;
+  for (int i = 0; i < len; ++i) {
+    const int phys = row_phys[i];
+    if (phys >= strip_size) continue;
+    const int step = Stepped ? row_steps[i] : i;
+    uint8_t q = step < full ? 255 : (step == full ? head : 0);
+    if (Layered) {
+      for (size_t k = 1; k < layer_count_; ++k) {
+        const int top = step < layer_full[k] ? 255 : (step == layer_full[k] ? layer_head[k] : 0);
+        switch (layers_[k].blend) {
+          case LayerBlend::Max:
+            q = (uint8_t) std::max<int>(q, top);
+            break;
+          case LayerBlend::Add:
+            q = (uint8_t) std::min(255, q + top);
+            break;
+          case LayerBlend::Subtract:
+            q = (uint8_t) std::max(0, q - top);
+            break;
         }
       }
     }
-
-    const int lit_int = (int) std::floor(row.lit_count + kEpsilon);
-    if (row.active && !row.finished) {
-      if (should_unlock_on(row.row_len, lit_int, cfg.row_threshold)) {
-        const int next = neighbor_row((int) ridx, from_top);
-        if (next >= 0 && !rows_[next].active) activate_row(next);
-      }
+    if (!repaint_all && row_shadow[i] == q && !(Wobble && q != 0)) continue;
+    if (row_shadow[i] != q) {
+      level_delta += (int32_t) q - row_shadow[i];
+      row_shadow[i] = q;
     }
-
-    const int len = row.row_len;
-    const int full = std::min(lit_int, len);
-    const float frac = clamp01(row.lit_count - (float) full);
-    for (int i = 0; i < len; ++i) {
-      const int phys = row_phys_at(*map_, (int) ridx, i, cfg.snake);
-      if (phys < 0 || phys >= strip.size()) continue;
-      float intensity = 0.0f;
-      if (i < full) intensity = 1.0f;
-      else if (i == full && full < len) intensity = apply_ease(cfg.ease, frac);
-      strip[phys] = color_with_wobble(base_state, cfg, (int) ridx, phys, intensity, t_sec);
+    if (q == 0) {
+      strip[phys] = esphome::Color::BLACK;
+    } else {
+      esphome::Color c = base;
+      if (Wobble) c = palette_.sample(sin_bam_q15(phase + (uint32_t) phys * kLedPhaseMul + row_phase));
+      strip[phys] = q == 255 ? c : scale_color_u8(c, q);
     }
+    leds_written_++;
+  }
+  rows_.level[ridx] += (uint32_t) level_delta;
+  output_level_ += (uint32_t) level_delta;
+}
+
+template<typename Strip>
+inline size_t FcobProgressTracker::fill_span(Strip &strip,
+                                             int strip_size,
+                                             const uint16_t *row_phys,
+                                             uint8_t *row_shadow,
+                                             int from,
+                                             int to,
+                                             uint8_t q,
+                                             const esphome::Color &color) {
+  size_t written = 0;
+  for (int i = from; i < to; ++i) {
+    const int phys = row_phys[i];
+    if (phys >= strip_size) continue;
+    strip[phys] = color;
+    row_shadow[i] = q;
+    written++;
   }
+  leds_written_ += written;
+  return written;
 }
 
-// Progress OFF animation and repaint rows with wobble applied.
-inline void FcobProgressTracker::handle_off_frame(esphome::light::AddressableLight &strip,
-                                                  const RuntimeConfig &cfg,
-                                                  const BaseColorState &base_state,
-                                                  float t_sec,
-                                                  uint32_t dt_ms) {
-  if (!map_) return;
-  const uint32_t step_ms = compute_step_ms(cfg.per_led_ms, cfg.fade_steps);
-  const float substep = 1.0f / (float) std::max(1, cfg.fade_steps);
-  const bool from_top = plan_.order == RowOrder::TopToBottom;
+inline bool PixelBuffer::resize(size_t size) {
+  if (pixels_.size() == size) return false;
+  pixels_.assign(size, esphome::Color::BLACK);
+  marked_.assign(size, 0);
+  written_.clear();
+  written_.reserve(size);
+  return true;
+}
 
-  for (size_t ridx = 0; ridx < rows_.size(); ++ridx) {
-    auto &row = rows_[ridx];
-    if (row.row_len <= 0) {
-      row.finished = true;
-      continue;
+inline size_t PixelBuffer::present(esphome::light::AddressableLight &strip) {
+  const size_t count = written_.size();
+  if (count == 0) return 0;
+  const int32_t limit = std::min(strip.size(), size());
+  if (count * 2 >= pixels_.size()) {
+    // Mostly rewritten (wobble, full repaints): one sequential pass is cheaper
+    // than chasing the written list.
+    for (int32_t i = 0; i < limit; ++i) {
+      if (marked_[i]) strip[i] = pixels_[i];
     }
-    if (row.active && !row.finished && step_ms > 0) {
-      if (advance_one_substep(row.substep_acc, step_ms, dt_ms)) {
-        row.lit_count -= substep;
-        if (row.lit_count <= kEpsilon) {
-          row.lit_count = 0.0f;
-          row.finished = true;
-          row.active = false;
-        }
-      }
+    std::memset(marked_.data(), 0, marked_.size());
+  } else {
+    for (uint16_t idx : written_) {
+      marked_[idx] = 0;
+      if (idx < limit) strip[idx] = pixels_[idx];
     }
+  }
+  written_.clear();
+  return count;
+}
 
-    const int lit_int = (int) std::floor(row.lit_count + kEpsilon);
-    if (row.active && !row.finished) {
-      if (should_unlock_off(row.row_len, lit_int, cfg.row_threshold)) {
-        const int next = neighbor_row((int) ridx, from_top);
-        if (next >= 0 && !rows_[next].active) activate_row(next);
-      }
-    }
+inline bool AsyncRenderer::start(FcobProgressTracker *tracker) {
+  if (running_) return true;
+  tracker_ = tracker;
+  quit_.store(false, std::memory_order_relaxed);
+  state_.store(kIdle, std::memory_order_relaxed);
+#if defined(USE_ESP32)
+#if portNUM_PROCESSORS < 2
+  return false;
+#else
+  exited_.store(false, std::memory_order_relaxed);
+  const BaseType_t core = xPortGetCoreID() == 0 ? 1 : 0;
+  if (xTaskCreatePinnedToCore(&AsyncRenderer::task_entry, "stairs_render", 4096, this, 1, &task_, core) != pdPASS)
+    return false;
+#endif
+#elif defined(USE_HOST)
+  thread_ = std::thread([this] { run(); });
+#else
+  return false;
+#endif
+  running_ = true;
+  return true;
+}
 
-    const int len = row.row_len;
-    const int full = std::min(lit_int, len);
-    const float frac = clamp01(row.lit_count - (float) full);
-    for (int i = 0; i < len; ++i) {
-      const int phys = row_phys_at(*map_, (int) ridx, i, cfg.snake);
-      if (phys < 0 || phys >= strip.size()) continue;
-      float intensity = 0.0f;
-      if (i < full) intensity = 1.0f;
-      else if (i == full && full < len) intensity = apply_ease(cfg.ease, frac);
-      strip[phys] = color_with_wobble(base_state, cfg, (int) ridx, phys, intensity, t_sec);
-    }
+inline void AsyncRenderer::stop() {
+  if (!running_) return;
+  wait_idle();
+  quit_.store(true, std::memory_order_release);
+  wake();
+#if defined(USE_ESP32)
+  while (!exited_.load(std::memory_order_acquire)) vTaskDelay(1);
+  task_ = nullptr;
+#elif defined(USE_HOST)
+  thread_.join();
+#endif
+  running_ = false;
+}
+
+inline void AsyncRenderer::wait_idle() const {
+  while (!idle()) {
+#if defined(USE_ESP32)
+    taskYIELD();
+#elif defined(USE_HOST)
+    std::this_thread::yield();
+#endif
   }
 }
 
+inline void AsyncRenderer::submit(const RuntimeConfig &cfg, const esphome::Color &base_color, uint32_t now_ms) {
+  cfg_ = cfg;
+  color_ = base_color;
+  now_ms_ = now_ms;
+  state_.store(kQueued, std::memory_order_release);
+  wake();
+}
+
+// Worker loop: sleep until a frame is queued, paint it, hand everything back.
+inline void AsyncRenderer::run() {
+  while (true) {
+    wait_for_work();
+    if (quit_.load(std::memory_order_acquire)) break;
+    if (state_.load(std::memory_order_acquire) != kQueued) continue;
+    tracker_->render_frame(canvas_, cfg_, color_, now_ms_);
+    state_.store(kIdle, std::memory_order_release);
+  }
+}
+
+#if defined(USE_ESP32)
+inline void AsyncRenderer::task_entry(void *arg) {
+  auto *self = static_cast<AsyncRenderer *>(arg);
+  self->run();
+  self->exited_.store(true, std::memory_order_release);
+  vTaskDelete(nullptr);
+}
+
+inline void AsyncRenderer::wake() { xTaskNotifyGive(task_); }
+
+inline void AsyncRenderer::wait_for_work() { ulTaskNotifyTake(pdTRUE, portMAX_DELAY); }
+#elif defined(USE_HOST)
+inline void AsyncRenderer::wake() {
+  // Taking the lock orders the notify after the waiter's predicate check.
+  { std::lock_guard<std::mutex> lock(wake_mutex_); }
+  wake_cv_.notify_one();
+}
+
+inline void AsyncRenderer::wait_for_work() {
+  std::unique_lock<std::mutex> lock(wake_mutex_);
+  wake_cv_.wait(lock, [this] {
+    return quit_.load(std::memory_order_acquire) || state_.load(std::memory_order_acquire) == kQueued;
+  });
+}
+#else
+inline void AsyncRenderer::wake() {}
+inline void AsyncRenderer::wait_for_work() {}
+#endif
+
+// Holds end on the clock, plan steps when the tracker reports them finished.
+inline const EffectPlan *Sequencer::advance(bool plan_finished, uint32_t now_ms) {
+  if (sequence_ == nullptr) return nullptr;
+  const SequenceStep &current = sequence_->steps[step_];
+  const bool done = current.hold_ms != 0 ? now_ms - step_start_ms_ >= current.hold_ms : plan_finished;
+  if (!done) return nullptr;
+  if (++step_ >= sequence_->steps.size()) {
+    sequence_ = nullptr;
+    return nullptr;
+  }
+  step_start_ms_ = now_ms;
+  const SequenceStep &next = sequence_->steps[step_];
+  return next.hold_ms != 0 ? nullptr : &next.plan;
+}
+
+// Fill the derived fields from the raw knobs.
+inline void RuntimeConfig::derive() {
+  step_ms = compute_step_ms(per_led_ms, fade_steps);
+  ease_table = &ease_table_for(*this);
+}
+
+// Process-wide counter so configs from different effects never share a version.
+inline uint32_t next_config_version() {
+  static uint32_t version = 0;
+  if (++version == 0) ++version;
+  return version;
+}
+
 // Convert per-LED timing + fade steps into a sub-step interval.
 inline uint32_t compute_step_ms(uint32_t per_led_ms, int fade_steps) {
   if (fade_steps <= 0) fade_steps = 1;
@@ -550,6 +2098,65 @@ inline float apply_ease(EaseProfile ease, float t) {
   }
 }
 
+// Sample a curve at 256 points into a byte table.
+template<typename F> inline EaseTable EaseTable::bake(F curve) {
+  EaseTable table;
+  for (int k = 0; k < 256; ++k) {
+    const float y = clamp01(curve((float) k / 255.0f));
+    table.lut[k] = (uint8_t) std::lround(y * 255.0f);
+  }
+  return table;
+}
+
+inline EaseTable EaseTable::from_profile(EaseProfile ease) {
+  return bake([ease](float t) { return apply_ease(ease, t); });
+}
+
+// CSS-style cubic-bezier(x1, y1, x2, y2); x(t) is solved by bisection at bake time.
+inline EaseTable EaseTable::cubic_bezier(float x1, float y1, float x2, float y2) {
+  auto bez = [](float a, float b, float t) {
+    const float u = 1.0f - t;
+    return 3.0f * u * u * t * a + 3.0f * u * t * t * b + t * t * t;
+  };
+  return bake([&](float x) {
+    float lo = 0.0f, hi = 1.0f;
+    for (int i = 0; i < 24; ++i) {
+      const float mid = 0.5f * (lo + hi);
+      if (bez(x1, x2, mid) < x) lo = mid;
+      else hi = mid;
+    }
+    return bez(y1, y2, 0.5f * (lo + hi));
+  });
+}
+
+// (e^(k t) - 1) / (e^k - 1): k > 0 eases in, k < 0 eases out, 0 is linear.
+inline EaseTable EaseTable::exponential(float k) {
+  if (std::fabs(k) < 1e-4f) return from_profile(EaseProfile::Linear);
+  const float denom = std::expm1(k);
+  return bake([k, denom](float t) { return std::expm1(k * t) / denom; });
+}
+
+// Built-in profiles, baked on first use.
+inline const EaseTable &builtin_ease_table(EaseProfile ease) {
+  static const EaseTable linear = EaseTable::from_profile(EaseProfile::Linear);
+  static const EaseTable cubic = EaseTable::from_profile(EaseProfile::CubicInOut);
+  static const EaseTable quint = EaseTable::from_profile(EaseProfile::QuintInOut);
+  switch (ease) {
+    case EaseProfile::Linear:
+      return linear;
+    case EaseProfile::QuintInOut:
+      return quint;
+    default:
+      return cubic;
+  }
+}
+
+// Table for the configured profile (custom curves carry their own).
+inline const EaseTable &ease_table_for(const RuntimeConfig &cfg) {
+  if (cfg.ease_table != nullptr) return *cfg.ease_table;
+  return builtin_ease_table(cfg.ease);
+}
+
 // Decide when the next row should unlock based on threshold progress.
 inline bool should_unlock(int len, int progress, float thr, bool off_mode) {
   if (len <= 0) return false;
@@ -621,7 +2228,67 @@ inline int scan_resume_row_prefix(esphome::light::AddressableLight &strip,
       break;
     }
   }
-  return esphome::clamp(lit, 0, len);
+  return esphome::clamp(lit, 0, len);
+}
+
+// Same as above over a compiled row (already snake-ordered).
+inline int scan_resume_row_prefix(esphome::light::AddressableLight &strip, const uint16_t *phys,
+                                  int len) {
+  const int size = strip.size();
+  int lit = 0;
+  for (int i = 0; i < len; ++i) {
+    if (phys[i] >= size || !is_led_lit_soft(strip, phys[i])) break;
+    lit = i + 1;
+  }
+  return lit;
+}
+
+// Same for a row lit by several heads: lit steps end at the first step with a
+// dark LED, whichever head it belongs to.
+inline int scan_resume_row_steps(esphome::light::AddressableLight &strip,
+                                 const uint16_t *phys,
+                                 const uint16_t *steps,
+                                 int len,
+                                 int span) {
+  const int size = strip.size();
+  int lit = span;
+  for (int i = 0; i < len; ++i) {
+    if (steps[i] < lit && (phys[i] >= size || !is_led_lit_soft(strip, phys[i]))) lit = steps[i];
+  }
+  return lit;
+}
+
+// Steps a row of len LEDs takes to fill: the longest run any one head covers.
+inline uint16_t head_span(int len, HeadMode mode, int count) {
+  if (len <= 0) return 0;
+  switch (mode) {
+    case HeadMode::BothEnds:
+    case HeadMode::Center:
+      return (uint16_t) ((len + 1) / 2);
+    case HeadMode::Spaced: {
+      const int heads = esphome::clamp(count, 1, len);
+      return (uint16_t) ((len + heads - 1) / heads);
+    }
+    case HeadMode::Single:
+    default:
+      return (uint16_t) len;
+  }
+}
+
+// Step at which LED i of such a row lights. Center rows of even length start
+// from the middle pair.
+inline uint16_t head_step(int i, int len, HeadMode mode, int count) {
+  switch (mode) {
+    case HeadMode::BothEnds:
+      return (uint16_t) std::min(i, len - 1 - i);
+    case HeadMode::Center:
+      return (uint16_t) (std::abs(2 * i - (len - 1)) / 2);
+    case HeadMode::Spaced:
+      return (uint16_t) (i % head_span(len, mode, count));
+    case HeadMode::Single:
+    default:
+      return (uint16_t) i;
+  }
 }
 
 // Quick brightness check with hysteresis to detect "lit" LEDs.
@@ -641,18 +2308,42 @@ inline esphome::Color scale_color(const esphome::Color &c, float factor) {
   return esphome::Color(apply(c.r), apply(c.g), apply(c.b));
 }
 
+// Integer intensity scale: round(channel * scale / 255) per channel.
+inline esphome::Color scale_color_u8(const esphome::Color &c, uint8_t scale) {
+  auto apply = [scale](uint8_t channel) -> uint8_t {
+    const uint32_t v = (uint32_t) channel * scale + 128u;
+    return (uint8_t) ((v + (v >> 8)) >> 8);
+  };
+  return esphome::Color(apply(c.r), apply(c.g), apply(c.b));
+}
+
 // Advance time accumulators by at most one sub-step per frame.
-inline bool advance_one_substep(float &acc_ms, uint32_t step_ms, uint32_t dt_ms) {
+inline bool advance_one_substep(uint16_t &acc_ms, uint32_t step_ms, uint32_t dt_ms) {
   if (step_ms == 0) return false;
   const uint32_t cap = step_ms * 2u;
-  uint32_t dt = dt_ms;
-  if (dt > cap) dt = cap;
-  acc_ms += (float) dt;
-  if (acc_ms >= step_ms) {
-    acc_ms -= (float) step_ms;
-    return true;
-  }
-  return false;
+  uint32_t acc = acc_ms + std::min(dt_ms, cap);
+  const bool step = acc >= step_ms;
+  if (step) acc -= step_ms;
+  acc_ms = (uint16_t) std::min<uint32_t>(acc, 0xFFFF);
+  return step;
+}
+
+// Position of a Q16.16 lit count on the 1/fade_steps grid, rounded to the
+// nearest sub-step.
+inline uint32_t q16_to_substeps(uint32_t lit, int fade_steps) {
+  const uint64_t steps = (uint64_t) std::max(1, fade_steps);
+  return (uint32_t) ((lit >> 16) * steps + (((lit & 0xFFFFu) * steps + 0x8000u) >> 16));
+}
+
+// Inverse of q16_to_substeps(): whole LEDs plus the rounded head fraction.
+inline uint32_t substeps_to_q16(uint32_t count, int fade_steps) {
+  const uint64_t steps = (uint64_t) std::max(1, fade_steps);
+  return (uint32_t) (((count / steps) << 16) | ((((count % steps) << 16) + steps / 2) / steps));
+}
+
+inline uint32_t q16_from_float(float leds) {
+  if (!(leds > 0.0f)) return 0;
+  return (uint32_t) std::min(std::lround(leds * (float) kQ16One), (long) 0xFFFF0000L);
 }
 
 // Clamp a float to [0,1].
@@ -712,9 +2403,25 @@ inline esphome::Color hsv2rgb(float h, float s, float v) {
   return esphome::Color(rr, gg, bb);
 }
 
-// Degrees-based sine helper.
+// Table sine of a 2^32-per-turn phase, linearly interpolated, in Q15.
+inline int32_t sin_bam_q15(uint32_t phase) {
+  const uint32_t idx = phase >> 24;
+  const int32_t frac = (int32_t) ((phase >> 8) & 0xFFFFu);
+  const int32_t a = kSinQ15[idx];
+  const int32_t b = kSinQ15[idx + 1];
+  return a + (((b - a) * frac) >> 16);
+}
+
+// Phase advance for a wobble frequency (deg/s) over dt_ms; wraps modulo one turn.
+inline uint32_t wobble_phase_step(float freq_deg, uint32_t dt_ms) {
+  return (uint32_t) (int64_t) std::llround(freq_deg * kBamPerDegMs * (float) dt_ms);
+}
+
+// Degrees-based sine helper (table driven).
 inline float sin_deg_fast(float degrees) {
-  return std::sinf(degrees * (kPi / 180.0f));
+  const float turns = degrees / 360.0f;
+  const float wrapped = turns - std::floor(turns);
+  return sin_bam_q15((uint32_t) (int64_t) (wrapped * 4294967296.0f)) * (1.0f / 32767.0f);
 }
 
 // Smoothstep helper for wobble amplitude scaling.
@@ -723,12 +2430,48 @@ inline float smoothstep(float edge0, float edge1, float x) {
   return t * t * (3.0f - 2.0f * t);
 }
 
+// True when wobble will actually shift hues for this color/config.
+inline bool wobble_is_live(const BaseColorState &base_state, const RuntimeConfig &cfg) {
+  if (!cfg.wobble_enabled || cfg.wobble_amp_deg <= 0.0f || cfg.wobble_freq_deg == 0.0f) return false;
+  if (base_state.v <= 0.0f) return false;
+  return smoothstep(kWobbleVMin, kWobbleVMax, base_state.v) > 0.0f;
+}
+
+// Hue swing in degrees after fading wobble in with the base color's V.
+inline float wobble_hue_amp(const BaseColorState &base_state, const RuntimeConfig &cfg) {
+  return cfg.wobble_amp_deg * smoothstep(kWobbleVMin, kWobbleVMax, base_state.v);
+}
+
+// Entry i sits at sin_q15 = i * 1024 - 32767 so sample() needs no rescale.
+inline void WobblePalette::prepare(const BaseColorState &base_state, float hue_amp) {
+  if (key_rgb == base_state.rgb && key_amp == hue_amp) return;
+  key_rgb = base_state.rgb;
+  key_amp = hue_amp;
+  for (int i = 0; i <= kSteps; ++i) {
+    const float offset = (float) (i * 1024 - 32767) * (hue_amp / 32767.0f);
+    entries[i] = hsv2rgb(base_state.h + offset, base_state.s, base_state.v);
+  }
+}
+
+// HSV->RGB is piecewise linear in hue, so blending neighbours stays within 1 LSB.
+inline esphome::Color WobblePalette::sample(int32_t sin_q15) const {
+  const uint32_t pos = (uint32_t) (sin_q15 + 32767);
+  const uint32_t idx = pos >> 10;
+  const int32_t frac = (int32_t) (pos & 0x3FFu);
+  const esphome::Color &a = entries[idx];
+  const esphome::Color &b = entries[idx + 1];
+  auto lerp = [frac](uint8_t x, uint8_t y) -> uint8_t {
+    return (uint8_t) (x + ((((int32_t) y - (int32_t) x) * frac + 0x200) >> 10));
+  };
+  return esphome::Color(lerp(a.r, b.r), lerp(a.g, b.g), lerp(a.b, b.b));
+}
+
 // Sample a wobble-adjusted color for a specific LED.
 inline esphome::Color wobble_sample(const BaseColorState &base_state,
                                     const RuntimeConfig &cfg,
                                     int row_index,
                                     int phys_led,
-                                    float t_sec) {
+                                    uint32_t phase) {
   if (!cfg.wobble_enabled || cfg.wobble_amp_deg <= 0.0f || base_state.v <= 0.0f) {
     return base_state.rgb;
   }
@@ -736,11 +2479,10 @@ inline esphome::Color wobble_sample(const BaseColorState &base_state,
   if (amp_scale <= 0.0f) return base_state.rgb;
 
   const float hue_amp = cfg.wobble_amp_deg * amp_scale;
-  float phase = t_sec * cfg.wobble_freq_deg;
-  phase += (float) phys_led * kLedPhaseMul;
-  phase += (float) row_index * kRowPhaseMul;
+  phase += (uint32_t) phys_led * kLedPhaseMul;
+  phase += (uint32_t) row_index * kRowPhaseMul;
 
-  const float hue = base_state.h + sin_deg_fast(phase) * hue_amp;
+  const float hue = base_state.h + (float) sin_bam_q15(phase) * (hue_amp / 32767.0f);
   return hsv2rgb(hue, base_state.s, base_state.v);
 }
 
@@ -750,13 +2492,13 @@ inline esphome::Color color_with_wobble(const BaseColorState &base_state,
                                         int row_index,
                                         int phys_led,
                                         float intensity,
-                                        float t_sec) {
+                                        uint32_t phase) {
   intensity = clamp01(intensity);
   if (intensity <= 0.0f) return esphome::Color::BLACK;
 
   esphome::Color c = base_state.rgb;
   if (cfg.wobble_enabled && cfg.wobble_amp_deg > 0.0f && cfg.wobble_freq_deg != 0.0f) {
-    c = wobble_sample(base_state, cfg, row_index, phys_led, t_sec);
+    c = wobble_sample(base_state, cfg, row_index, phys_led, phase);
   }
   if (intensity >= 0.999f) return c;
   return scale_color(c, intensity);
@@ -770,17 +2512,24 @@ inline MapValidationResult validate_led_map(const std::vector<std::vector<int>>
   }
 
   const bool enforce_upper = total_leds > 0;
-  std::vector<uint8_t> seen_upper;
-  std::unordered_set<int> seen_dynamic;
-  if (enforce_upper) {
-    seen_upper.assign(static_cast<size_t>(total_leds), 0u);
-  } else {
-    seen_dynamic.reserve(map.size() * 16u);
+  // The compiled layout cannot address kInvalidPhys or above, so a longer
+  // strip still caps indices there rather than compiling them to dead slots.
+  const int upper = enforce_upper ? std::min(total_leds, (int) kInvalidPhys) : (int) kInvalidPhys;
+  // One bit per LED for duplicate detection: sized by the bound, or else by
+  // the largest index the layout can address that the map uses.
+  int seen_size = enforce_upper ? upper : 0;
+  if (!enforce_upper) {
+    for (const auto &row : map) {
+      for (int idx : row) {
+        if (idx < kInvalidPhys) seen_size = std::max(seen_size, idx + 1);
+      }
+    }
   }
+  std::vector<uint32_t> seen((static_cast<size_t>(seen_size) + 31) / 32, 0u);
 
   size_t total_entries = 0;
-  int min_idx = std::numeric_limits<int>::max();
-  int max_idx = std::numeric_limits<int>::min();
+  size_t word_idx = 0;
+  uint32_t word = 0;
 
   for (size_t r = 0; r < map.size(); ++r) {
     const auto &row = map[r];
@@ -790,41 +2539,39 @@ inline MapValidationResult validate_led_map(const std::vector<std::vector<int>>
     }
     for (size_t c = 0; c < row.size(); ++c) {
       int idx = row[c];
-      if (idx < 0) {
-        res.message = esphome::str_sprintf("ERROR: row %zu col %zu has negative idx %d", r, c, idx);
-        return res;
-      }
-      if (enforce_upper && idx >= total_leds) {
-        res.message = esphome::str_sprintf("ERROR: row %zu col %zu index %d outside 0..%d", r, c, idx, total_leds - 1);
+      if ((unsigned) idx >= (unsigned) upper) {
+        if (idx < 0) {
+          res.message = esphome::str_sprintf("ERROR: row %zu col %zu has negative idx %d", r, c, idx);
+        } else {
+          res.message = esphome::str_sprintf("ERROR: row %zu col %zu index %d outside 0..%d", r, c, idx, upper - 1);
+        }
         return res;
       }
 
-      bool duplicate = false;
-      if (enforce_upper) {
-        if (seen_upper[(size_t) idx]) duplicate = true;
-        else seen_upper[(size_t) idx] = 1;
-      } else {
-        auto [_, inserted] = seen_dynamic.insert(idx);
-        if (!inserted) duplicate = true;
+      // Rows are mostly runs, so the current word stays in a register until
+      // an index lands in another one.
+      if ((size_t) idx >> 5 != word_idx) {
+        seen[word_idx] = word;
+        word_idx = (size_t) idx >> 5;
+        word = seen[word_idx];
       }
-      if (duplicate) {
+      const uint32_t bit = 1u << (idx & 31);
+      if ((word & bit) != 0) {
         res.message = esphome::str_sprintf("ERROR: duplicate index %d at row %zu col %zu", idx, r, c);
         return res;
       }
-
-      min_idx = std::min(min_idx, idx);
-      max_idx = std::max(max_idx, idx);
-      total_entries++;
+      word |= bit;
     }
+    total_entries += row.size();
   }
+  seen[word_idx] = word;
 
-  if (total_entries == 0) {
-    res.message = "ERROR: map contains no LEDs";
-    return res;
-  }
-
-  if (min_idx == std::numeric_limits<int>::max()) min_idx = 0;
-  if (max_idx == std::numeric_limits<int>::min()) max_idx = 0;
+  // The range comes from the bitset, which costs a word per 32 LEDs.
+  size_t lo = 0, hi = seen.size() - 1;
+  while (seen[lo] == 0) ++lo;
+  while (seen[hi] == 0) --hi;
+  const int min_idx = (int) (lo * 32 + __builtin_ctz(seen[lo]));
+  const int max_idx = (int) (hi * 32 + 31 - __builtin_clz(seen[hi]));
 
   res.valid = true;
   if (enforce_upper) {
@@ -837,6 +2584,110 @@ inline MapValidationResult validate_led_map(const std::vector<std::vector<int>>
   return res;
 }
 
+inline esphome::Color PowerLimiter::limit(const esphome::Color &color, uint32_t level, float brightness,
+                                          bool settled) {
+  const float ma_per_level = (float) (color.r + color.g + color.b) * (channel_ma_ / (255.0f * 255.0f)) * brightness;
+  const float full_ma = (float) level * ma_per_level;
+  // Growth comes in bursts (fade sub-steps, rows unlocking), so the largest
+  // recent one is held and decays slowly.
+  growth_ = std::max(level > last_level_ ? level - last_level_ : 0u, growth_ - growth_ / 8);
+  last_level_ = level;
+  const uint32_t next = level + growth_;
+  if (budget_ma_ > 0.0f) {
+    const float next_ma = (float) next * ma_per_level;
+    const float fit = next_ma > budget_ma_ ? 255.0f * budget_ma_ / next_ma : 255.0f;
+    if (level == 0) {
+      scale_ = 255;
+    } else if (fit < scale_) {
+      // 1/16 below what fits, so the next few frames of a fill fit too.
+      scale_ = (uint8_t) std::max(1.0f, fit * (15.0f / 16.0f));
+    } else if (settled && fit >= scale_ + 2.0f) {
+      scale_ = (uint8_t) fit;
+    }
+  }
+  estimate_ma_ = full_ma * scale_ / 255.0f;
+  return scale_ == 255 ? color : scale_color_u8(color, scale_);
+}
+
+// Parse the `{{0,1,2},{5,4,3}}` text form of a map (as led_map accepts it in
+// YAML) into `out`, reusing its rows. An item may also be a run `a-b`,
+// reversed when a > b. Only the syntax is checked; see validate_led_map().
+inline MapValidationResult parse_led_map(const std::string &text, std::vector<std::vector<int>> &out) {
+  MapValidationResult res;
+  const char *p = text.c_str();
+  auto skip_space = [&p]() {
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') ++p;
+  };
+  auto expect = [&p](char ch) {
+    if (*p != ch) return false;
+    ++p;
+    return true;
+  };
+  // Leaves p on the first digit when the number is missing or too large.
+  auto number = [&p](int &value) {
+    const char *q = p;
+    long v = 0;
+    while (*q >= '0' && *q <= '9') {
+      v = v * 10 + (*q++ - '0');
+      if (v >= kInvalidPhys) return false;
+    }
+    if (q == p) return false;
+    p = q;
+    value = (int) v;
+    return true;
+  };
+  auto fail = [&res, &p, &text](const char *what) {
+    res.message = esphome::str_sprintf("ERROR: %s at offset %zu", what, (size_t) (p - text.c_str()));
+    return res;
+  };
+
+  size_t rows = 0;
+  skip_space();
+  if (!expect('{')) return fail("expected '{'");
+  skip_space();
+  while (*p != '}') {
+    if (rows != 0) {
+      if (!expect(',')) return fail("expected ','");
+      skip_space();
+    }
+    if (!expect('{')) return fail("expected '{'");
+    if (out.size() <= rows) out.emplace_back();
+    auto &row = out[rows++];
+    row.clear();
+    skip_space();
+    while (*p != '}') {
+      if (!row.empty()) {
+        if (!expect(',')) return fail("expected ','");
+        skip_space();
+      }
+      int from, to;
+      if (!number(from)) return fail("expected an LED index below 65535");
+      skip_space();
+      to = from;
+      if (*p == '-') {
+        ++p;
+        skip_space();
+        if (!number(to)) return fail("expected an LED index below 65535");
+        skip_space();
+      }
+      const int step = to >= from ? 1 : -1;
+      for (int idx = from;; idx += step) {
+        row.push_back(idx);
+        if (idx == to) break;
+      }
+    }
+    ++p;
+    skip_space();
+  }
+  ++p;
+  skip_space();
+  if (*p != '\0') return fail("unexpected text after the map");
+  out.resize(rows);
+  res.valid = true;
+  res.message.clear();
+  return res;
+}
+
 }  // namespace ledhelpers
 
 namespace esphome {
@@ -846,38 +2697,246 @@ static const char *const TAG = "stairs_effects";
 
 using led_map_t = std::vector<std::vector<int>>;
 
+// Render diagnostics accumulated between two stats publishes.
+struct RenderStats {
+  uint32_t frames{0};
+  uint32_t apply_last_us{0};
+  uint64_t apply_sum_us{0};
+  uint32_t apply_max_us{0};
+  uint32_t intervals{0};
+  uint64_t jitter_sum_us{0};
+  uint64_t leds_written{0};
+  uint32_t dt_clamps{0};
+  size_t tracker_bytes{0};
+};
+
+class StairsBaseEffect;
+
 class StairsEffectsComponent : public Component {
  public:
-  void setup() override { this->validate_map(); }
-  void loop() override {}
+  void setup() override;
+  void loop() override;
 
   void set_led_map(globals::GlobalsComponent<led_map_t> *map) { led_map_holder_ = map; }
 
+  // Map baked into flash by codegen; status is the build-time validation summary.
+  void set_static_led_map(const uint32_t *row_offsets, const uint16_t *phys, const uint16_t *phys_snake,
+                          size_t rows, const char *status) {
+    static_map_ = {row_offsets, phys, phys_snake, rows};
+    static_map_status_ = status;
+  }
+
   const led_map_t *led_map() const {
+    if (runtime_map_active_) return &runtime_map_;
     return led_map_holder_ != nullptr ? &led_map_holder_->value() : nullptr;
   }
+  // Replace the map without a reboot: `text` in the led_map string form, or
+  // empty to reload the led_map_id globals after a lambda edited them (the
+  // tracker keeps its compiled copy until then).
+  // It is parsed, validated and compiled here while the worker may still be
+  // rendering, then swapped in between frames; running effects carry on over
+  // the new rows (see FcobProgressTracker::swap_layout()). False, with the
+  // current map kept, when the new one does not validate.
+  bool set_map(const std::string &text);
+  // Point the shared tracker at the flash map, else the globals map; false
+  // when neither has rows.
+  bool bind_tracker() {
+    if (static_map_.rows != 0) {
+      tracker_.bind_static_map(&static_map_);
+      return true;
+    }
+    const auto *map = led_map();
+    if (map == nullptr || map->empty()) return false;
+    tracker_.bind_map(map);
+    return true;
+  }
   void set_led_count(int32_t count) { led_count_ = count; }
   void set_map_valid_sensor(binary_sensor::BinarySensor *sensor) { map_valid_sensor_ = sensor; }
   void set_map_status_sensor(text_sensor::TextSensor *sensor) { map_status_sensor_ = sensor; }
+  void add_cubic_bezier_easing(const std::string &name, float x1, float y1, float x2, float y2) {
+    easing_curves_.emplace_back(name, ledhelpers::EaseTable::cubic_bezier(x1, y1, x2, y2));
+  }
+  void add_exponential_easing(const std::string &name, float k) {
+    easing_curves_.emplace_back(name, ledhelpers::EaseTable::exponential(k));
+  }
+  // Baked table for an Easing select option defined under easing_curves.
+  const ledhelpers::EaseTable *find_easing_curve(const std::string &name) const {
+    for (const auto &curve : easing_curves_) {
+      if (curve.first == name) return &curve.second;
+    }
+    return nullptr;
+  }
+#ifdef USE_SENSOR
+  void set_apply_time_last_sensor(sensor::Sensor *sensor) { apply_time_last_sensor_ = sensor; }
+  void set_apply_time_avg_sensor(sensor::Sensor *sensor) { apply_time_avg_sensor_ = sensor; }
+  void set_apply_time_max_sensor(sensor::Sensor *sensor) { apply_time_max_sensor_ = sensor; }
+  void set_frame_jitter_sensor(sensor::Sensor *sensor) { frame_jitter_sensor_ = sensor; }
+  void set_leds_written_sensor(sensor::Sensor *sensor) { leds_written_sensor_ = sensor; }
+  void set_dt_clamps_sensor(sensor::Sensor *sensor) { dt_clamps_sensor_ = sensor; }
+  void set_tracker_heap_sensor(sensor::Sensor *sensor) { tracker_heap_sensor_ = sensor; }
+  void set_trigger_latency_sensor(sensor::Sensor *sensor) { trigger_latency_sensor_ = sensor; }
+  void set_power_estimate_sensor(sensor::Sensor *sensor) { power_estimate_sensor_ = sensor; }
+#endif
+  // Progress shared by every effect bound to this component, so switching
+  // effects hands over exact per-row state instead of re-reading the strip.
+  ledhelpers::FcobProgressTracker &tracker() { return tracker_; }
+  void set_stats_interval(uint32_t interval_ms) { stats_interval_ms_ = interval_ms; }
+  void set_stats_enabled(bool enabled) { stats_enabled_ = enabled; }
+  // Effects only time their frames when a render sensor is configured.
+  bool stats_enabled() const { return stats_enabled_; }
+  // Account one apply() that started at start_us and took apply_us.
+  void record_frame(uint32_t start_us, uint32_t apply_us, size_t leds_written, bool dt_clamped,
+                    size_t tracker_bytes);
+  void set_async_render(bool async_render) { async_render_ = async_render; }
+  // Where each row's fill heads start and how long a row takes (0: per_led_ms
+  // per head step); see FcobProgressTracker::set_row_heads()/set_row_time().
+  void set_row_heads(ledhelpers::HeadMode mode, int count) { tracker_.set_row_heads(mode, count); }
+  void set_row_time(uint32_t row_ms) { tracker_.set_row_time(row_ms); }
+  // Current this component's LEDs may draw (0: no limit) and what one color
+  // channel of one LED draws at full; see ledhelpers::PowerLimiter.
+  void set_power_budget(float budget_ma, float channel_ma) { power_.configure(budget_ma, channel_ma); }
+  // Base color for the next frame of brightness-scaled output, scaled down
+  // when the last frame's estimate is over the budget. Called while the
+  // caller owns the tracker.
+  Color limit_power(const Color &color, float brightness) {
+    return power_.limit(color, tracker_.output_level(), brightness, tracker_.finished());
+  }
+  void clear_power_estimate() { power_.clear_estimate(); }
+  float power_estimate_ma() const { return power_.estimate_ma(); }
+  // Background renderer when async_render is on and the chip can run one;
+  // nullptr means effects render inside apply().
+  ledhelpers::AsyncRenderer *async_renderer() { return async_render_ && renderer_.running() ? &renderer_ : nullptr; }
+  // Forget the previous frame time so an effect (re)start is not a jitter spike.
+  void restart_frame_clock() { have_frame_start_ = false; }
   bool map_is_valid() const { return map_checked_ && map_valid_; }
   const std::string &map_status() const { return map_status_; }
   void ensure_map_checked() {
     if (!map_checked_) validate_map();
   }
+  // Black out the LEDs of this component's map (in range of the strip).
+  void blank_leds(light::AddressableLight &it) const;
+  // Effects register from init() so trigger() can find them by plan.
+  void register_effect(StairsBaseEffect *effect) { effects_.push_back(effect); }
+  // Switch the light to the effect playing flow/order and paint its first
+  // frame before returning; false when no such effect is bound or there is
+  // nothing to do (an off plan while the light is off).
+  bool trigger(ledhelpers::FlowMode flow, ledhelpers::RowOrder order);
+  // Run flow/order as a tracker layer on top of the effect already playing
+  // (see FcobProgressTracker::add_layer()) and paint its first frame; falls
+  // back to trigger() when nothing is playing or every layer is in use.
+  bool trigger_layer(ledhelpers::FlowMode flow, ledhelpers::RowOrder order, ledhelpers::LayerBlend blend);
+  // Set from trigger() until the triggered effect has shown its first frame.
+  bool trigger_pending() const { return trigger_pending_; }
+  void trigger_frame_shown();
+  // Trigger-to-first-frame time of the last trigger() in microseconds.
+  uint32_t trigger_latency_us() const { return trigger_latency_us_; }
+
+  // Sequences are filled during codegen: add_sequence() opens one and the
+  // step calls append to it.
+  void add_sequence(const std::string &name) { sequences_.push_back({name, {}}); }
+  void add_sequence_plan(ledhelpers::FlowMode flow, ledhelpers::RowOrder order) {
+    sequences_.back().steps.push_back({{flow, order}, 0});
+  }
+  void add_sequence_hold(uint32_t hold_ms) { sequences_.back().steps.push_back({{}, hold_ms}); }
+  // Trigger the sequence's first plan and follow its steps from the frame
+  // loop. Running it again keeps an unfinished first plan going, restarts a
+  // running hold, and otherwise starts over from the first plan in place.
+  bool start_sequence(const char *name);
+  void stop_sequence() { sequencer_.stop(); }
+  bool sequence_running() const { return sequencer_.running(); }
+  // Called by the running effect once per frame with the tracker's finished
+  // flag; returns a plan to start in place, or nullptr.
+  const ledhelpers::EffectPlan *advance_sequence(bool plan_finished, uint32_t now_ms) {
+    return sequencer_.advance(plan_finished, now_ms);
+  }
 
  private:
   globals::GlobalsComponent<led_map_t> *led_map_holder_{nullptr};
+  ledhelpers::StaticLedMap static_map_{};
+  const char *static_map_status_{nullptr};
+  // Map uploaded through set_map(); replaces the flash and globals maps.
+  led_map_t runtime_map_;
+  bool runtime_map_active_{false};
   int32_t led_count_{0};
   bool map_checked_{false};
   bool map_valid_{false};
   std::string map_status_{"map not checked"};
   binary_sensor::BinarySensor *map_valid_sensor_{nullptr};
   text_sensor::TextSensor *map_status_sensor_{nullptr};
+  // Filled during codegen only, so pointers handed out later stay valid.
+  std::vector<std::pair<std::string, ledhelpers::EaseTable>> easing_curves_;
+  ledhelpers::FcobProgressTracker tracker_;
+  // Declared after tracker_ so the worker is stopped before the tracker goes.
+  ledhelpers::AsyncRenderer renderer_;
+  bool async_render_{false};
+#ifdef USE_SENSOR
+  sensor::Sensor *apply_time_last_sensor_{nullptr};
+  sensor::Sensor *apply_time_avg_sensor_{nullptr};
+  sensor::Sensor *apply_time_max_sensor_{nullptr};
+  sensor::Sensor *frame_jitter_sensor_{nullptr};
+  sensor::Sensor *leds_written_sensor_{nullptr};
+  sensor::Sensor *dt_clamps_sensor_{nullptr};
+  sensor::Sensor *tracker_heap_sensor_{nullptr};
+  sensor::Sensor *trigger_latency_sensor_{nullptr};
+  sensor::Sensor *power_estimate_sensor_{nullptr};
+  float published_power_ma_{-1.0f};
+#endif
+  ledhelpers::PowerLimiter power_;
+  std::vector<StairsBaseEffect *> effects_;
+  std::vector<ledhelpers::Sequence> sequences_;
+  ledhelpers::Sequencer sequencer_;
+  bool trigger_pending_{false};
+  bool trigger_latency_ready_{false};
+  uint32_t trigger_us_{0};
+  uint32_t trigger_latency_us_{0};
+  bool stats_enabled_{false};
+  uint32_t stats_interval_ms_{10000};
+  uint32_t last_stats_publish_ms_{0};
+  uint32_t last_power_publish_ms_{0};
+  RenderStats stats_{};
+  bool have_frame_start_{false};
+  uint32_t last_frame_start_us_{0};
+  uint32_t last_frame_interval_us_{0};
 
   void validate_map();
   void publish_map_status();
+  void publish_render_stats();
+};
+
+// Auto power-down: the light is switched off once the effect has been done
+// for a delay, so a finished off plan is seen settled first.
+class ShutdownTimer {
+ public:
+  void reset() { scheduled_ = false; }
+  // True once `done` has held for delay_ms; rearms afterwards.
+  bool update(bool done, uint32_t delay_ms) {
+    if (!done) {
+      scheduled_ = false;
+      return false;
+    }
+    if (!scheduled_) {
+      scheduled_ = true;
+      at_ms_ = millis() + delay_ms;
+      return false;
+    }
+    if ((int32_t) (millis() - at_ms_) < 0) return false;
+    scheduled_ = false;
+    return true;
+  }
+
+ protected:
+  bool scheduled_{false};
+  uint32_t at_ms_{0};
 };
 
+inline void power_off(light::LightState *state) {
+  auto call = state->make_call();
+  call.set_state(false);
+  call.perform();
+}
+
+class StairsCompositeEffect;
+
 class StairsBaseEffect : public light::AddressableLightEffect {
  public:
   StairsBaseEffect(StairsEffectsComponent *parent,
@@ -894,27 +2953,66 @@ class StairsBaseEffect : public light::AddressableLightEffect {
   void set_wobble_frequency_number(number::Number *num) { wobble_frequency_number_ = num; }
   void set_easing_select(select::Select *sel) { easing_select_ = sel; }
   void set_shutdown_delay(uint32_t delay_ms) { shutdown_delay_ms_ = delay_ms; }
+  void set_analytic_timing(bool analytic) { analytic_timing_ = analytic; }
 
   void start() override {
     this->initialized_ = false;
-    this->shutdown_scheduled_ = false;
+    this->shutdown_.reset();
     this->logged_invalid_map_ = false;
+    this->parent_->restart_frame_clock();
+    // Selecting an effect by hand ends any sequence; start_sequence() starts
+    // its sequencer after this.
+    this->parent_->stop_sequence();
     light::AddressableLightEffect::start();
   }
+  void stop() override {
+    this->parent_->stop_sequence();
+    this->parent_->clear_power_estimate();
+    light::AddressableLightEffect::stop();
+  }
+  void init() override;
   void apply(light::AddressableLight &it, const Color &current_color) override;
+  using light::AddressableLightEffect::apply;
+  // One frame of this effect's plan onto its LEDs, without showing it;
+  // returns the LEDs written. apply() adds the show and auto power-down.
+  size_t render(light::AddressableLight &it, const Color &current_color);
+  // The plan is a finished off plan with no sequence step left.
+  bool off_done() const { return off_done_; }
+
+  // Segments can play any plan; whole-strip effects only their own.
+  bool plays(ledhelpers::FlowMode flow, ledhelpers::RowOrder order) const {
+    return composite_ != nullptr || (flow_ == flow && order_ == order);
+  }
+  bool is_segment() const { return composite_ != nullptr; }
+  void set_composite(StairsCompositeEffect *composite) { composite_ = composite; }
+  // Switch a segment's plan; it resumes from the shared progress next frame.
+  void set_plan(ledhelpers::FlowMode flow, ledhelpers::RowOrder order) {
+    flow_ = flow;
+    order_ = order;
+    off_mode_ = flow == ledhelpers::FlowMode::Off;
+    initialized_ = false;
+  }
+  // Take over the light without a transition and render the first frame now.
+  // Segments switch to flow/order inside their composite instead.
+  bool trigger(ledhelpers::FlowMode flow, ledhelpers::RowOrder order);
+  // The light is on with this effect (or its composite) running and past
+  // its first frame, so the tracker holds its progress.
+  bool playing() const;
+  // Render and show a frame now rather than on the light's next loop.
+  void paint_now();
 
  protected:
   StairsEffectsComponent *parent_;
   ledhelpers::FlowMode flow_;
   ledhelpers::RowOrder order_;
   bool off_mode_;
-  ledhelpers::FcobProgressTracker tracker_;
 
+  StairsCompositeEffect *composite_{nullptr};
   bool initialized_{false};
-  bool snake_state_{false};
-  bool shutdown_scheduled_{false};
-  uint32_t shutdown_at_{0};
+  bool off_done_{false};
+  ShutdownTimer shutdown_;
   bool logged_invalid_map_{false};
+  float last_brightness_{-1.0f};
 
   number::Number *per_led_number_{nullptr};
   number::Number *fade_steps_number_{nullptr};
@@ -925,8 +3023,15 @@ class StairsBaseEffect : public light::AddressableLightEffect {
   number::Number *wobble_frequency_number_{nullptr};
   select::Select *easing_select_{nullptr};
   uint32_t shutdown_delay_ms_{50};
+  bool analytic_timing_{false};
+
+  // Cached config, rebuilt only after a control's state callback fired.
+  ledhelpers::RuntimeConfig cfg_{};
+  bool cfg_dirty_{true};
 
   ledhelpers::RuntimeConfig build_runtime_config() const;
+  const ledhelpers::RuntimeConfig &runtime_config();
+  void blank(light::AddressableLight &it);
 };
 
 class StairsFillUpEffect : public StairsBaseEffect {
@@ -949,11 +3054,51 @@ class StairsOffDownEffect : public StairsBaseEffect {
   StairsOffDownEffect(StairsEffectsComponent *parent, const std::string &name);
 };
 
+// One component's part of a StairsCompositeEffect, starting on flow/order.
+class StairsSegmentEffect : public StairsBaseEffect {
+ public:
+  StairsSegmentEffect(StairsEffectsComponent *parent, const std::string &name, ledhelpers::FlowMode flow,
+                      ledhelpers::RowOrder order);
+};
+
+// Several components sharing one strip: each frame renders every segment
+// onto its own map's LEDs and shows the strip once, so flights animate
+// independently for the cost of one transmission.
+class StairsCompositeEffect : public light::AddressableLightEffect {
+ public:
+  explicit StairsCompositeEffect(const std::string &name);
+  void add_segment(StairsBaseEffect *segment) {
+    segment->set_composite(this);
+    segments_.push_back(segment);
+  }
+  void set_shutdown_delay(uint32_t delay_ms) { shutdown_delay_ms_ = delay_ms; }
+
+  void init() override;
+  void start() override;
+  void stop() override;
+  void apply(light::AddressableLight &it, const Color &current_color) override;
+  using light::AddressableLightEffect::apply;
+  // Switch one segment to flow/order in place, turning the light on with
+  // this effect if needed, and paint a frame now.
+  bool trigger_segment(StairsBaseEffect *segment, ledhelpers::FlowMode flow, ledhelpers::RowOrder order);
+
+ protected:
+  std::vector<StairsBaseEffect *> segments_;
+  uint32_t shutdown_delay_ms_{50};
+  ShutdownTimer shutdown_;
+};
+
 // ---- Inline implementations ----
 
 inline void StairsEffectsComponent::validate_map() {
   ledhelpers::MapValidationResult result;
-  if (led_map_holder_ == nullptr) {
+  if (runtime_map_active_) {
+    result = ledhelpers::validate_led_map(runtime_map_, led_count_);
+  } else if (static_map_.rows != 0) {
+    // Already validated by codegen; nothing left to check on the device.
+    result.valid = true;
+    result.message = static_map_status_;
+  } else if (led_map_holder_ == nullptr) {
     result.valid = false;
     result.message = "ERROR: led_map not bound";
   } else {
@@ -965,6 +3110,43 @@ inline void StairsEffectsComponent::validate_map() {
   publish_map_status();
 }
 
+inline bool StairsEffectsComponent::set_map(const std::string &text) {
+  const bool reload = text.empty();
+  led_map_t map;
+  ledhelpers::MapValidationResult result;
+  if (!reload) {
+    result = ledhelpers::parse_led_map(text, map);
+    if (result.valid) result = ledhelpers::validate_led_map(map, led_count_);
+  } else if (led_map_holder_ == nullptr) {
+    result.message = "ERROR: led_map not bound";
+  } else {
+    result = ledhelpers::validate_led_map(led_map_holder_->value(), led_count_);
+  }
+  if (!result.valid) {
+    ESP_LOGW(TAG, "Map upload rejected: %s", result.message.c_str());
+    return false;
+  }
+  ledhelpers::LedLayout layout;
+  layout.compile(reload ? led_map_holder_->value() : map);
+  // Only the swap itself waits for the worker.
+  if (auto *async = async_renderer()) async->wait_idle();
+  if (reload) {
+    runtime_map_active_ = false;
+    runtime_map_ = {};
+  } else {
+    runtime_map_ = std::move(map);
+    runtime_map_active_ = true;
+  }
+  static_map_.rows = 0;
+  tracker_.swap_layout(led_map(), layout);
+  map_checked_ = true;
+  map_valid_ = true;
+  map_status_ = result.message;
+  publish_map_status();
+  ESP_LOGI(TAG, "Map replaced: %s", map_status_.c_str());
+  return true;
+}
+
 inline void StairsEffectsComponent::publish_map_status() {
 #ifdef USE_BINARY_SENSOR
   if (map_valid_sensor_ != nullptr) map_valid_sensor_->publish_state(map_checked_ && map_valid_);
@@ -974,6 +3156,187 @@ inline void StairsEffectsComponent::publish_map_status() {
 #endif
 }
 
+inline void StairsEffectsComponent::record_frame(uint32_t start_us, uint32_t apply_us, size_t leds_written,
+                                                 bool dt_clamped, size_t tracker_bytes) {
+  stats_.frames++;
+  stats_.apply_last_us = apply_us;
+  stats_.apply_sum_us += apply_us;
+  if (apply_us > stats_.apply_max_us) stats_.apply_max_us = apply_us;
+  stats_.leds_written += leds_written;
+  if (dt_clamped) stats_.dt_clamps++;
+  stats_.tracker_bytes = tracker_bytes;
+
+  // Jitter: mean change between consecutive frame intervals.
+  if (have_frame_start_) {
+    const uint32_t interval = start_us - last_frame_start_us_;
+    if (last_frame_interval_us_ != 0) {
+      stats_.jitter_sum_us += interval > last_frame_interval_us_ ? interval - last_frame_interval_us_
+                                                                 : last_frame_interval_us_ - interval;
+      stats_.intervals++;
+    }
+    last_frame_interval_us_ = interval;
+  } else {
+    last_frame_interval_us_ = 0;
+  }
+  last_frame_start_us_ = start_us;
+  have_frame_start_ = true;
+}
+
+inline void StairsEffectsComponent::setup() {
+  this->validate_map();
+  // Size everything the effects touch up front so apply() never allocates:
+  // tracker storage from the map (and led_count), then bind to fill it.
+  size_t rows = static_map_.rows;
+  size_t leds = rows != 0 ? static_map_.row_offsets[rows] : 0;
+  if (const auto *map = led_map()) {
+    rows = map->size();
+    for (const auto &row : *map) leds += row.size();
+  }
+  leds = std::max(leds, (size_t) std::max<int32_t>(led_count_, 0));
+  tracker_.reserve(rows, leds);
+  if (map_valid_) bind_tracker();
+  if (async_render_) {
+    // Started here, on the loop task, so the worker lands on the other core.
+    if (renderer_.start(&tracker_)) {
+      renderer_.canvas().resize(leds);
+    } else {
+      ESP_LOGW(TAG, "async_render needs a second core; rendering in the loop");
+      async_render_ = false;
+    }
+  }
+}
+
+inline void StairsEffectsComponent::loop() {
+  if (trigger_latency_ready_) {
+    // Published from loop() so the trigger path never waits on the API.
+    trigger_latency_ready_ = false;
+#ifdef USE_SENSOR
+    if (trigger_latency_sensor_ != nullptr) trigger_latency_sensor_->publish_state(trigger_latency_us_);
+#endif
+  }
+  const uint32_t now = millis();
+#ifdef USE_SENSOR
+  // On the stats cadence, and only when the estimate moved.
+  if (power_estimate_sensor_ != nullptr && power_.estimate_ma() != published_power_ma_ &&
+      now - last_power_publish_ms_ >= stats_interval_ms_) {
+    last_power_publish_ms_ = now;
+    published_power_ma_ = power_.estimate_ma();
+    power_estimate_sensor_->publish_state(published_power_ma_);
+  }
+#endif
+  if (!stats_enabled_) return;
+  if (now - last_stats_publish_ms_ < stats_interval_ms_) return;
+  last_stats_publish_ms_ = now;
+  // Nothing to report while no effect is rendering; sensors keep their last value.
+  if (stats_.frames == 0) return;
+  publish_render_stats();
+  stats_ = RenderStats{};
+}
+
+inline void StairsEffectsComponent::publish_render_stats() {
+#ifdef USE_SENSOR
+  const float frames = (float) stats_.frames;
+  if (apply_time_last_sensor_ != nullptr) apply_time_last_sensor_->publish_state(stats_.apply_last_us);
+  if (apply_time_avg_sensor_ != nullptr) apply_time_avg_sensor_->publish_state(stats_.apply_sum_us / frames);
+  if (apply_time_max_sensor_ != nullptr) apply_time_max_sensor_->publish_state(stats_.apply_max_us);
+  if (frame_jitter_sensor_ != nullptr && stats_.intervals > 0)
+    frame_jitter_sensor_->publish_state(stats_.jitter_sum_us / (float) stats_.intervals / 1000.0f);
+  if (leds_written_sensor_ != nullptr) leds_written_sensor_->publish_state(stats_.leds_written / frames);
+  if (dt_clamps_sensor_ != nullptr) dt_clamps_sensor_->publish_state(stats_.dt_clamps);
+  if (tracker_heap_sensor_ != nullptr) tracker_heap_sensor_->publish_state(stats_.tracker_bytes);
+#endif
+}
+
+inline bool StairsEffectsComponent::trigger(ledhelpers::FlowMode flow, ledhelpers::RowOrder order) {
+  const uint32_t start_us = micros();
+  // A direct trigger takes over from any running sequence.
+  sequencer_.stop();
+  // A composite segment owns this component's LEDs whenever there is one.
+  StairsBaseEffect *target = nullptr;
+  for (auto *effect : effects_) {
+    if (!effect->plays(flow, order) || (target != nullptr && !effect->is_segment())) continue;
+    target = effect;
+  }
+  if (target != nullptr) {
+    trigger_us_ = start_us;
+    trigger_pending_ = true;
+    const bool started = target->trigger(flow, order);
+    // Cleared by the first frame; an invalid map renders no frame to time.
+    trigger_pending_ = false;
+    return started;
+  }
+  ESP_LOGW(TAG, "trigger: no %s %s effect uses this component", flow == ledhelpers::FlowMode::Fill ? "fill" : "off",
+           order == ledhelpers::RowOrder::BottomToTop ? "up" : "down");
+  return false;
+}
+
+inline bool StairsEffectsComponent::trigger_layer(ledhelpers::FlowMode flow, ledhelpers::RowOrder order,
+                                                  ledhelpers::LayerBlend blend) {
+  const uint32_t start_us = micros();
+  StairsBaseEffect *target = nullptr;
+  for (auto *effect : effects_) {
+    if (effect->playing()) target = effect;
+  }
+  if (target == nullptr) return trigger(flow, order);
+  // The worker must not be mid-frame while the tracker gains a layer.
+  if (auto *async = async_renderer()) async->wait_idle();
+  if (!tracker_.add_layer({flow, order}, blend)) {
+    ESP_LOGD(TAG, "trigger: no free layer, replacing the running plans");
+    return trigger(flow, order);
+  }
+  // Like trigger(), a layer takes over from any running sequence.
+  sequencer_.stop();
+  trigger_us_ = start_us;
+  trigger_pending_ = true;
+  target->paint_now();
+  trigger_pending_ = false;
+  return true;
+}
+
+inline void StairsEffectsComponent::blank_leds(light::AddressableLight &it) const {
+  const int32_t size = it.size();
+  if (static_map_.rows != 0) {
+    for (uint32_t i = 0; i < static_map_.row_offsets[static_map_.rows]; ++i) {
+      if (static_map_.phys[i] < size) it[static_map_.phys[i]] = Color::BLACK;
+    }
+  } else if (const auto *map = led_map()) {
+    for (const auto &row : *map) {
+      for (int idx : row) {
+        if (idx >= 0 && idx < size) it[idx] = Color::BLACK;
+      }
+    }
+  }
+}
+
+inline bool StairsEffectsComponent::start_sequence(const char *name) {
+  const ledhelpers::Sequence *sequence = nullptr;
+  for (const auto &candidate : sequences_) {
+    if (candidate.name == name) sequence = &candidate;
+  }
+  if (sequence == nullptr) {
+    ESP_LOGW(TAG, "unknown sequence '%s'", name);
+    return false;
+  }
+  if (sequencer_.sequence() == sequence) {
+    if (sequencer_.step() == 0) return true;
+    if (sequencer_.holding()) {
+      sequencer_.extend_hold(millis());
+      return true;
+    }
+  }
+  const auto &plan = sequence->steps.front().plan;
+  if (!trigger(plan.flow, plan.order)) return false;
+  sequencer_.start(sequence, millis());
+  return true;
+}
+
+inline void StairsEffectsComponent::trigger_frame_shown() {
+  trigger_pending_ = false;
+  trigger_latency_us_ = micros() - trigger_us_;
+  trigger_latency_ready_ = true;
+  ESP_LOGD(TAG, "trigger to first frame: %u us", (unsigned) trigger_latency_us_);
+}
+
 inline ledhelpers::RuntimeConfig StairsBaseEffect::build_runtime_config() const {
   ledhelpers::RuntimeConfig cfg;
   if (per_led_number_ != nullptr) {
@@ -992,20 +3355,80 @@ inline ledhelpers::RuntimeConfig StairsBaseEffect::build_runtime_config() const
     if (thr > 1.0f) thr = 1.0f;
     cfg.row_threshold = thr;
   }
+  cfg.analytic_timing = analytic_timing_;
   cfg.snake = snake_switch_ != nullptr ? snake_switch_->state : false;
   cfg.wobble_enabled = wobble_switch_ != nullptr ? wobble_switch_->state : false;
   if (wobble_strength_number_ != nullptr) cfg.wobble_amp_deg = wobble_strength_number_->state;
   if (wobble_frequency_number_ != nullptr) cfg.wobble_freq_deg = wobble_frequency_number_->state;
 
   if (easing_select_ != nullptr) {
-    auto state = easing_select_->current_option();
+    const auto &state = easing_select_->current_option();
     if (state == "Linear") cfg.ease = ledhelpers::EaseProfile::Linear;
     else if (state == "Quint InOut") cfg.ease = ledhelpers::EaseProfile::QuintInOut;
+    else if (state == "Cubic InOut") cfg.ease = ledhelpers::EaseProfile::CubicInOut;
+    else if ((cfg.ease_table = parent_->find_easing_curve(state)) != nullptr)
+      cfg.ease = ledhelpers::EaseProfile::Custom;
     else cfg.ease = ledhelpers::EaseProfile::CubicInOut;
   }
   return cfg;
 }
 
+// Subscribe to the controls so apply() never polls them.
+inline void StairsBaseEffect::init() {
+  auto mark_dirty = [this](auto &&...) { this->cfg_dirty_ = true; };
+  if (per_led_number_ != nullptr) per_led_number_->add_on_state_callback(mark_dirty);
+  if (fade_steps_number_ != nullptr) fade_steps_number_->add_on_state_callback(mark_dirty);
+  if (row_threshold_number_ != nullptr) row_threshold_number_->add_on_state_callback(mark_dirty);
+  if (snake_switch_ != nullptr) snake_switch_->add_on_state_callback(mark_dirty);
+  if (wobble_switch_ != nullptr) wobble_switch_->add_on_state_callback(mark_dirty);
+  if (wobble_strength_number_ != nullptr) wobble_strength_number_->add_on_state_callback(mark_dirty);
+  if (wobble_frequency_number_ != nullptr) wobble_frequency_number_->add_on_state_callback(mark_dirty);
+  if (easing_select_ != nullptr) easing_select_->add_on_state_callback(mark_dirty);
+  parent_->register_effect(this);
+}
+
+inline bool StairsBaseEffect::trigger(ledhelpers::FlowMode flow, ledhelpers::RowOrder order) {
+  if (composite_ != nullptr) return composite_->trigger_segment(this, flow, order);
+  // Nothing to scan out of a dark strip; do not turn the light on for it.
+  if (off_mode_ && !this->state_->remote_values.is_on()) return false;
+  // A zero-length call skips the brightness ramp (which would start the
+  // first frame near black) and restarts this effect, which resumes from the
+  // shared progress without reading the strip back.
+  auto call = this->state_->make_call();
+  call.set_state(true);
+  call.set_transition_length(0);
+  call.set_effect(this->get_name());
+  call.perform();
+  // Paint now rather than on the light's next loop.
+  light::AddressableLightEffect::apply();
+  return true;
+}
+
+inline bool StairsBaseEffect::playing() const {
+  const light::LightEffect *running =
+      composite_ != nullptr ? static_cast<const light::LightEffect *>(composite_) : this;
+  return initialized_ && this->state_ != nullptr && this->state_->remote_values.is_on() &&
+         this->state_->get_effect_name() == running->get_name();
+}
+
+inline void StairsBaseEffect::paint_now() {
+  if (composite_ != nullptr) {
+    static_cast<light::AddressableLightEffect *>(composite_)->apply();
+  } else {
+    light::AddressableLightEffect::apply();
+  }
+}
+
+inline const ledhelpers::RuntimeConfig &StairsBaseEffect::runtime_config() {
+  if (cfg_dirty_) {
+    cfg_ = this->build_runtime_config();
+    cfg_.derive();
+    cfg_.version = ledhelpers::next_config_version();
+    cfg_dirty_ = false;
+  }
+  return cfg_;
+}
+
 inline StairsBaseEffect::StairsBaseEffect(StairsEffectsComponent *parent,
                                           const std::string &name,
                                           ledhelpers::FlowMode flow,
@@ -1029,61 +3452,232 @@ inline StairsOffUpEffect::StairsOffUpEffect(StairsEffectsComponent *parent, cons
 inline StairsOffDownEffect::StairsOffDownEffect(StairsEffectsComponent *parent, const std::string &name)
     : StairsBaseEffect(parent, name, ledhelpers::FlowMode::Off, ledhelpers::RowOrder::TopToBottom, true) {}
 
-inline void StairsBaseEffect::apply(light::AddressableLight &it, const Color &current_color) {
+inline StairsSegmentEffect::StairsSegmentEffect(StairsEffectsComponent *parent, const std::string &name,
+                                                ledhelpers::FlowMode flow, ledhelpers::RowOrder order)
+    : StairsBaseEffect(parent, name, flow, order, flow == ledhelpers::FlowMode::Off) {}
+
+inline StairsCompositeEffect::StairsCompositeEffect(const std::string &name)
+    : light::AddressableLightEffect(name.c_str()) {}
+
+inline void StairsCompositeEffect::init() {
+  for (auto *segment : segments_) segment->init_internal(this->state_);
+}
+
+inline void StairsCompositeEffect::start() {
+  shutdown_.reset();
+  for (auto *segment : segments_) segment->start();
+  light::AddressableLightEffect::start();
+}
+
+inline void StairsCompositeEffect::stop() {
+  for (auto *segment : segments_) segment->stop();
+  light::AddressableLightEffect::stop();
+}
+
+inline void StairsCompositeEffect::apply(light::AddressableLight &it, const Color &current_color) {
+  size_t written = 0;
+  bool all_off = true;
+  for (auto *segment : segments_) {
+    written += segment->render(it, current_color);
+    all_off = all_off && segment->off_done();
+  }
+  if (written > 0) it.schedule_show();
+  // The strip goes dark only once every flight has finished turning off.
+  if (shutdown_.update(all_off, shutdown_delay_ms_)) power_off(this->state_);
+}
+
+inline bool StairsCompositeEffect::trigger_segment(StairsBaseEffect *segment, ledhelpers::FlowMode flow,
+                                                   ledhelpers::RowOrder order) {
+  const bool on = this->state_->remote_values.is_on();
+  if (flow == ledhelpers::FlowMode::Off && !on) return false;
+  segment->set_plan(flow, order);
+  if (!on || this->state_->get_effect_name() != this->get_name()) {
+    // Same zero-length call as a whole-strip trigger; the other segments
+    // resume their own plans.
+    auto call = this->state_->make_call();
+    call.set_state(true);
+    call.set_transition_length(0);
+    call.set_effect(this->get_name());
+    call.perform();
+  }
+  light::AddressableLightEffect::apply();
+  return true;
+}
+
+inline size_t StairsBaseEffect::render(light::AddressableLight &it, const Color &current_color) {
+  // With async_render the worker owns the tracker until its frame is painted;
+  // skip this loop if it is still busy, or wait for it when restarting.
+  auto *async = parent_->async_renderer();
+  if (async != nullptr && parent_->trigger_pending()) {
+    // A triggered frame is rendered here so it does not wait a loop for the
+    // worker; flush the worker's last frame first.
+    async->wait_idle();
+    async->canvas().present(it);
+    async = nullptr;
+  }
+  if (async != nullptr) {
+    if (!initialized_) {
+      async->wait_idle();
+    } else if (!async->idle()) {
+      return 0;
+    }
+  }
+
+  const bool stats_enabled = parent_->stats_enabled();
+  const uint32_t start_us = stats_enabled ? micros() : 0;
   parent_->ensure_map_checked();
   if (!parent_->map_is_valid()) {
     if (!logged_invalid_map_) {
       ESP_LOGE(TAG, "[%s] %s", this->get_name().c_str(), parent_->map_status().c_str());
       logged_invalid_map_ = true;
     }
-    for (int i = 0; i < it.size(); ++i) it[i] = Color::BLACK;
-    return;
+    this->blank(it);
+    off_done_ = false;
+    return 0;
   }
 
-  const auto *map = parent_->led_map();
-  if (map == nullptr || map->empty()) {
-    for (int i = 0; i < it.size(); ++i) it[i] = Color::BLACK;
-    return;
+  if (!parent_->bind_tracker()) {
+    this->blank(it);
+    off_done_ = false;
+    return 0;
   }
 
-  tracker_.bind_map(map);
-  auto cfg = this->build_runtime_config();
-  bool snake_now = cfg.snake;
-  bool restart = false;
-  if (!initialized_ || snake_now != snake_state_) restart = true;
-
-  if (restart) {
-    tracker_.sync_from_strip(it, snake_now);
-    tracker_.start_effect({flow_, order_}, true);
-    snake_state_ = snake_now;
+  auto &tracker = parent_->tracker();
+  const auto &cfg = this->runtime_config();
+
+  // Resume from the shared progress the previous effect left behind; only
+  // fall back to reading the strip back when something else repainted it.
+  // Snake toggles keep the logical progress and simply repaint.
+  if (!initialized_) {
+    // Flush the last background frame first so the strip matches the tracker.
+    if (async != nullptr) async->canvas().present(it);
+    if (!tracker.output_matches_strip(it)) tracker.sync_from_strip(it, cfg.snake);
+    tracker.start_effect({flow_, order_}, true);
+    if (parent_->trigger_pending()) tracker.lead_in();
     initialized_ = true;
-    shutdown_scheduled_ = false;
+    shutdown_.reset();
   }
 
-  tracker_.render_frame(it, cfg, current_color, millis());
+  // Strip writes bake in the light's brightness; settled pixels must be
+  // rewritten when it moves (transitions, HA brightness changes).
+  const float brightness =
+      this->state_->current_values.get_brightness() * this->state_->current_values.get_state();
+  if (brightness != last_brightness_) {
+    last_brightness_ = brightness;
+    tracker.invalidate_output();
+  }
+  if (async != nullptr && async->canvas().resize(it.size())) tracker.invalidate_output();
+  const Color color = parent_->limit_power(current_color, brightness);
+
+  // A finished plan with static output needs neither a render nor a
+  // retransmit; any control, color or brightness change wakes it up again.
+  const bool rendered = !tracker.idle(cfg, color);
+  size_t written = 0;
+  bool clamped = false;
+  if (async != nullptr) {
+    // Show the frame the worker finished since the last loop; the strip
+    // trails the tracker by one frame.
+    written = async->canvas().present(it);
+    clamped = written > 0 && tracker.dt_clamped();
+  } else if (rendered) {
+    tracker.render_frame(it, cfg, color, millis());
+    written = tracker.leds_written();
+    clamped = tracker.dt_clamped();
+  }
+  if (parent_->trigger_pending()) parent_->trigger_frame_shown();
 
-  it.schedule_show();
+  // Read everything needed from the tracker before the worker takes it back.
+  const bool finished = tracker.finished();
+  size_t tracker_bytes = 0;
+  if (stats_enabled) {
+    tracker_bytes = tracker.memory_usage() + (async != nullptr ? async->canvas().memory_usage() : 0);
+  }
+  // A sequence step that ends here starts the next plan in place.
+  const auto *next_plan = parent_->advance_sequence(finished, millis());
+  if (next_plan != nullptr) {
+    tracker.start_effect(*next_plan, true);
+    // A segment keeps the plan, so a composite restart resumes it.
+    if (composite_ != nullptr) this->set_plan(next_plan->flow, next_plan->order);
+  }
+  // Sequences change the plan under this effect, so auto power-down follows
+  // the tracker's plan rather than the effect's own flow.
+  off_done_ = finished && next_plan == nullptr && tracker.plan().flow == ledhelpers::FlowMode::Off &&
+              !parent_->sequence_running();
+  if (async != nullptr && (rendered || next_plan != nullptr)) async->submit(cfg, color, millis());
+  if (stats_enabled) parent_->record_frame(start_us, micros() - start_us, written, clamped, tracker_bytes);
+  return written;
+}
 
-  if (!off_mode_) return;
+inline void StairsBaseEffect::apply(light::AddressableLight &it, const Color &current_color) {
+  if (this->render(it, current_color) > 0) it.schedule_show();
+  if (shutdown_.update(off_done_, shutdown_delay_ms_)) power_off(this->state_);
+}
 
-  if (!tracker_.finished()) {
-    shutdown_scheduled_ = false;
+inline void StairsBaseEffect::blank(light::AddressableLight &it) {
+  // A segment only owns its map's LEDs; a whole-strip effect owns them all.
+  if (composite_ != nullptr) {
+    parent_->blank_leds(it);
     return;
   }
+  for (int i = 0; i < it.size(); ++i) it[i] = Color::BLACK;
+}
 
-  if (!shutdown_scheduled_) {
-    shutdown_scheduled_ = true;
-    shutdown_at_ = millis() + shutdown_delay_ms_;
-    return;
+template<typename... Ts> class TriggerAction : public Action<Ts...> {
+ public:
+  explicit TriggerAction(StairsEffectsComponent *parent) : parent_(parent) {}
+  TEMPLATABLE_VALUE(ledhelpers::FlowMode, flow)
+  TEMPLATABLE_VALUE(ledhelpers::RowOrder, order)
+  // Layer the plan over the running one instead of replacing it.
+  void set_layer(ledhelpers::LayerBlend blend) {
+    layered_ = true;
+    blend_ = blend;
   }
 
-  if ((int32_t)(millis() - shutdown_at_) >= 0) {
-    auto call = this->state_->make_call();
-    call.set_state(false);
-    call.perform();
-    shutdown_scheduled_ = false;
+  void play(Ts... x) override {
+    if (layered_) {
+      parent_->trigger_layer(this->flow_.value(x...), this->order_.value(x...), blend_);
+    } else {
+      parent_->trigger(this->flow_.value(x...), this->order_.value(x...));
+    }
   }
-}
+
+ protected:
+  StairsEffectsComponent *parent_;
+  bool layered_{false};
+  ledhelpers::LayerBlend blend_{ledhelpers::LayerBlend::Max};
+};
+
+template<typename... Ts> class StartSequenceAction : public Action<Ts...> {
+ public:
+  StartSequenceAction(StairsEffectsComponent *parent, const char *sequence) : parent_(parent), sequence_(sequence) {}
+
+  void play(Ts... x) override { parent_->start_sequence(sequence_); }
+
+ protected:
+  StairsEffectsComponent *parent_;
+  const char *sequence_;
+};
+
+template<typename... Ts> class SetMapAction : public Action<Ts...> {
+ public:
+  explicit SetMapAction(StairsEffectsComponent *parent) : parent_(parent) {}
+  TEMPLATABLE_VALUE(std::string, map)
+
+  void play(Ts... x) override { parent_->set_map(this->map_.value(x...)); }
+
+ protected:
+  StairsEffectsComponent *parent_;
+};
+
+template<typename... Ts> class StopSequenceAction : public Action<Ts...> {
+ public:
+  explicit StopSequenceAction(StairsEffectsComponent *parent) : parent_(parent) {}
+
+  void play(Ts... x) override { parent_->stop_sequence(); }
+
+ protected:
+  StairsEffectsComponent *parent_;
+};
 
 }  // namespace stairs_effects
 }  // namespace esphome